@@ -0,0 +1,507 @@
+/**
+ * @file analyse.c
+ * @brief Monte Carlo analysis of the fleet placement strategies.
+ *
+ * Plays millions of games of a placement strategy against several targeting
+ * AIs on all the cores, then prints the mean number of shots, the survival
+ * curve of the fleet and heat maps of the hits and shots per case.
+ * Each game draws its random numbers from its own generator seeded with the
+ * global seed and the game index, and the threads only add integer counters,
+ * so two runs with the same seed give exactly the same results whatever the
+ * number of threads.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "fonctions.h"
+
+#define NB_CASES (SIZE * SIZE) // number of cases of the board
+#define MAX_THREADS 256        // maximum number of threads
+#define MAX_TRIES 1000         // tries before a placement starts over
+
+/**
+ * @enum Strategy
+ * @brief Represents a fleet placement strategy.
+ */
+typedef enum
+{
+    STRATEGY_RANDOM,  /**< Same draw as initializeBoats. */
+    STRATEGY_EDGE,    /**< Every boat touches the edge of the board. */
+    STRATEGY_CLUSTER, /**< Every boat touches a boat already placed. */
+    STRATEGY_SPREAD,  /**< No boat touches another, even diagonally. */
+    NB_STRATEGIES
+} Strategy;
+
+/**
+ * @enum Targeting
+ * @brief Represents a targeting AI.
+ */
+typedef enum
+{
+    TARGETING_RANDOM, /**< Random shots, like computerTurn. */
+    TARGETING_HUNT,   /**< Random shots, then the neighbours of each hit. */
+    TARGETING_PARITY, /**< Like TARGETING_HUNT but hunts on one colour of a checkerboard. */
+    NB_TARGETINGS
+} Targeting;
+
+static const char *strategyNames[NB_STRATEGIES] = {"aleatoire", "bords", "groupe", "disperse"};
+static const char *targetingNames[NB_TARGETINGS] = {"aleatoire", "chasse", "parite"};
+
+/**
+ * @struct Stats
+ * @brief Counters of one targeting AI, added together at the end.
+ */
+typedef struct
+{
+    uint64_t games;                   /**< Number of games played. */
+    uint64_t shots;                   /**< Total number of shots. */
+    uint64_t sunkAt[NB_CASES + 1];    /**< Number of games won after n shots. */
+    uint64_t hits[NB_CASES];          /**< Number of hits on each case. */
+    uint64_t shotsPerCase[NB_CASES];  /**< Number of shots on each case. */
+} Stats;
+
+/**
+ * @struct Worker
+ * @brief Work of one thread.
+ */
+typedef struct
+{
+    Strategy strategy;           /**< Placement strategy analysed. */
+    uint64_t seed;               /**< Global seed. */
+    uint64_t first;              /**< Index of the first game of the thread. */
+    uint64_t last;               /**< Index after the last game of the thread. */
+    Stats stats[NB_TARGETINGS];  /**< Counters of the thread. */
+} Worker;
+
+/**
+ * @struct Target
+ * @brief State of a targeting AI during one game.
+ */
+typedef struct
+{
+    int remaining[NB_CASES]; /**< Cases not shot yet. */
+    int position[NB_CASES];  /**< Index of each case in remaining, -1 once shot. */
+    int nbRemaining;         /**< Number of cases not shot yet. */
+    int stack[4 * NB_CASES]; /**< Cases to shoot after a hit. */
+    int nbStack;             /**< Number of cases in the stack. */
+} Target;
+
+/*!
+ * \brief function to reset a board and a fleet between two games
+ * \param board the board
+ * \param fleet the fleet
+ */
+static void resetGame(Board *board, Fleet *fleet)
+{
+    clearBoard(board);
+    fleet->nbBoats = 0;
+    fleet->sunkMask = 0;
+}
+
+/*!
+ * \brief function to count the boat cases around a boat
+ * \param board the board
+ * \param boat the boat
+ * \param diagonals 1 to count the diagonal neighbours too, 0 otherwise
+ * \return the number of boat cases touching the boat
+ */
+static int countNeighbours(Board *board, Boat *boat, int diagonals)
+{
+    int count = 0;
+    int width = boat->orientation == HORIZONTAL ? boat->size : 1;
+    int height = boat->orientation == VERTICAL ? boat->size : 1;
+    for (int x = boat->x - 1; x <= boat->x + width; x++)
+    {
+        for (int y = boat->y - 1; y <= boat->y + height; y++)
+        {
+            int outsideX = x < boat->x || x >= boat->x + width;
+            int outsideY = y < boat->y || y >= boat->y + height;
+            if (x < 0 || y < 0 || x >= board->size || y >= board->size || (!outsideX && !outsideY))
+            {
+                continue;
+            }
+            if (!diagonals && outsideX && outsideY)
+            {
+                continue;
+            }
+            if (getCase(board, x, y) == BOAT)
+            {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+/*!
+ * \brief function to check if a boat follows a placement strategy
+ * \param board the board
+ * \param boat the boat
+ * \param strategy the strategy
+ * \param placed the number of boats already placed
+ * \return 1 if the boat follows the strategy, 0 otherwise
+ */
+static int followsStrategy(Board *board, Boat *boat, Strategy strategy, int placed)
+{
+    int endX = boat->x + (boat->orientation == HORIZONTAL ? boat->size - 1 : 0);
+    int endY = boat->y + (boat->orientation == VERTICAL ? boat->size - 1 : 0);
+    switch (strategy)
+    {
+    case STRATEGY_EDGE:
+        return boat->x == 0 || boat->y == 0 || endX == board->size - 1 || endY == board->size - 1;
+    case STRATEGY_CLUSTER:
+        return placed == 0 || countNeighbours(board, boat, 0) > 0;
+    case STRATEGY_SPREAD:
+        return countNeighbours(board, boat, 1) == 0;
+    default:
+        return 1;
+    }
+}
+
+/*!
+ * \brief function to place a fleet with a strategy
+ * \param board the board, reset by the function
+ * \param fleet the fleet, reset by the function
+ * \param strategy the strategy
+ * \param rng the generator of the game
+ */
+static void placeFleet(Board *board, Fleet *fleet, Strategy strategy, Rng *rng)
+{
+    // Boat sizes for 5 boats, same as initializeBoats
+    int boatSizes[] = {5, 4, 3, 3, 2};
+    int i = 0;
+    resetGame(board, fleet);
+    while (i < NB_BOAT)
+    {
+        Boat boat;
+        int tries = 0;
+        do
+        {
+            // same draw as initializeBoats, rejected until it follows the strategy
+            boat.size = boatSizes[i];
+            boat.x = randomBelow(rng, board->size);
+            boat.y = randomBelow(rng, board->size);
+            boat.orientation = randomBelow(rng, 2) == 0 ? HORIZONTAL : VERTICAL;
+            tries++;
+        } while (tries < MAX_TRIES && (!canPlaceBoat(board, &boat) || !followsStrategy(board, &boat, strategy, i)));
+
+        if (tries == MAX_TRIES)
+        {
+            // the boats already placed leave no room, start over
+            resetGame(board, fleet);
+            i = 0;
+            continue;
+        }
+        placeBoat(board, &boat);
+        addBoatToFleet(fleet, &boat, NULL);
+        i++;
+    }
+}
+
+/*!
+ * \brief function to mark a case as shot for a targeting AI
+ * \param target the state of the AI
+ * \param cell the case
+ */
+static void removeCase(Target *target, int cell)
+{
+    int index = target->position[cell];
+    int moved = target->remaining[--target->nbRemaining];
+    target->remaining[index] = moved;
+    target->position[moved] = index;
+    target->position[cell] = -1;
+}
+
+/*!
+ * \brief function to choose the next case to shoot
+ * \param target the state of the AI
+ * \param targeting the AI
+ * \param rng the generator of the game
+ * \return the case to shoot
+ */
+static int chooseCase(Target *target, Targeting targeting, Rng *rng)
+{
+    // finish the boats already hit first
+    while (targeting != TARGETING_RANDOM && target->nbStack > 0)
+    {
+        int cell = target->stack[--target->nbStack];
+        if (target->position[cell] != -1)
+        {
+            return cell;
+        }
+    }
+    if (targeting == TARGETING_PARITY)
+    {
+        // every boat covers at least one case of each colour
+        for (int tries = 0; tries < NB_CASES; tries++)
+        {
+            int cell = target->remaining[randomBelow(rng, target->nbRemaining)];
+            if ((cell / SIZE + cell % SIZE) % 2 == 0)
+            {
+                return cell;
+            }
+        }
+    }
+    return target->remaining[randomBelow(rng, target->nbRemaining)];
+}
+
+/*!
+ * \brief function to push the neighbours of a hit on the stack of the AI
+ * \param target the state of the AI
+ * \param cell the case hit
+ */
+static void pushNeighbours(Target *target, int cell)
+{
+    int x = cell / SIZE;
+    int y = cell % SIZE;
+    if (x > 0)
+        target->stack[target->nbStack++] = cell - SIZE;
+    if (x < SIZE - 1)
+        target->stack[target->nbStack++] = cell + SIZE;
+    if (y > 0)
+        target->stack[target->nbStack++] = cell - 1;
+    if (y < SIZE - 1)
+        target->stack[target->nbStack++] = cell + 1;
+}
+
+/*!
+ * \brief function to play one game of a targeting AI against a placed fleet
+ * \param board the board with the fleet placed
+ * \param fleet the fleet
+ * \param targeting the AI
+ * \param rng the generator of the game
+ * \param stats the counters of the AI
+ */
+static void playGame(Board *board, Fleet *fleet, Targeting targeting, Rng *rng, Stats *stats)
+{
+    Target target;
+    target.nbRemaining = NB_CASES;
+    target.nbStack = 0;
+    for (int i = 0; i < NB_CASES; i++)
+    {
+        target.remaining[i] = i;
+        target.position[i] = i;
+    }
+
+    int shots = 0;
+    while (!isFleetWrecked(fleet))
+    {
+        int cell = chooseCase(&target, targeting, rng);
+        removeCase(&target, cell);
+        ShotEvent outcome;
+        fireShot(board, cell / SIZE, cell % SIZE, fleet, &outcome);
+        shots++;
+        stats->shotsPerCase[cell]++;
+        if (outcome.type != SHOT_MISS)
+        {
+            stats->hits[cell]++;
+            if (outcome.type == SHOT_HIT)
+            {
+                pushNeighbours(&target, cell);
+            }
+        }
+    }
+    stats->games++;
+    stats->shots += shots;
+    stats->sunkAt[shots]++;
+}
+
+/*!
+ * \brief function run by each thread
+ * \param arg the work of the thread
+ * \return NULL
+ */
+static void *runWorker(void *arg)
+{
+    Worker *worker = arg;
+    Board *board = NULL;
+    Fleet fleet;
+    if (createBoard(SIZE, &board) != STATUS_OK)
+    {
+        printf("Error: allocation failed for board\n");
+        exit(1);
+    }
+
+    for (uint64_t game = worker->first; game < worker->last; game++)
+    {
+        for (int targeting = 0; targeting < NB_TARGETINGS; targeting++)
+        {
+            // every AI faces the same fleet, whatever the thread playing the game
+            Rng rng;
+            seedRandom(&rng, worker->seed ^ (game * 0xD1B54A32D192ED03ULL));
+            placeFleet(board, &fleet, worker->strategy, &rng);
+            playGame(board, &fleet, targeting, &rng, &worker->stats[targeting]);
+        }
+    }
+
+    freeBoard(board);
+    return NULL;
+}
+
+/*!
+ * \brief function to print a heat map in percent
+ * \param title the title of the map
+ * \param counts the counter of each case
+ * \param games the number of games
+ */
+static void displayHeatMap(const char *title, const uint64_t *counts, uint64_t games)
+{
+    printf("%s (%% des parties):\n   ", title);
+    for (int j = 0; j < SIZE; j++)
+    {
+        printf("%4d", j);
+    }
+    printf("\n");
+    for (int i = 0; i < SIZE; i++)
+    {
+        printf("%2d ", i);
+        for (int j = 0; j < SIZE; j++)
+        {
+            printf("%4.0f", 100.0 * counts[i * SIZE + j] / games);
+        }
+        printf("\n");
+    }
+}
+
+/*!
+ * \brief function to print the results of a targeting AI
+ * \param targeting the AI
+ * \param stats the counters of the AI
+ */
+static void displayStats(Targeting targeting, const Stats *stats)
+{
+    printf("==== IA %s ====\n", targetingNames[targeting]);
+    printf("Tirs moyens pour couler la flotte: %.3f\n", (double)stats->shots / stats->games);
+    printf("Survie de la flotte (%% des parties encore en jeu apres n tirs):\n");
+    uint64_t alive = stats->games;
+    for (int n = 0; n <= NB_CASES; n++)
+    {
+        alive -= stats->sunkAt[n];
+        if (n % 5 == 0)
+        {
+            printf("  %3d tirs: %6.2f%%\n", n, 100.0 * alive / stats->games);
+        }
+    }
+    displayHeatMap("Touches par case", stats->hits, stats->games);
+    displayHeatMap("Tirs par case", stats->shotsPerCase, stats->games);
+    printf("\n");
+}
+
+/*!
+ * \brief function to print how to use the program
+ * \param name the name of the program
+ */
+static void usage(const char *name)
+{
+    printf("Usage: %s [-p aleatoire|bords|groupe|disperse] [-n parties] [-t threads] [-s graine]\n", name);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    Strategy strategy = STRATEGY_RANDOM;
+    uint64_t games = 1000000;
+    uint64_t seed = 1;
+    // one thread per core by default, within the limits accepted by -t
+    long nbThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    nbThreads = nbThreads < 1 ? 1 : (nbThreads > MAX_THREADS ? MAX_THREADS : nbThreads);
+    int option;
+
+    while ((option = getopt(argc, argv, "p:n:t:s:")) != -1)
+    {
+        switch (option)
+        {
+        case 'p':
+            strategy = NB_STRATEGIES;
+            for (int i = 0; i < NB_STRATEGIES; i++)
+            {
+                if (strcmp(optarg, strategyNames[i]) == 0)
+                {
+                    strategy = i;
+                }
+            }
+            if (strategy == NB_STRATEGIES)
+            {
+                usage(argv[0]);
+            }
+            break;
+        case 'n':
+            games = strtoull(optarg, NULL, 10);
+            break;
+        case 't':
+            nbThreads = strtol(optarg, NULL, 10);
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 10);
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (games == 0 || nbThreads < 1 || nbThreads > MAX_THREADS)
+    {
+        usage(argv[0]);
+    }
+
+    Worker *workers = calloc(nbThreads, sizeof(Worker));
+    pthread_t *threads = malloc(nbThreads * sizeof(pthread_t));
+    if (workers == NULL || threads == NULL)
+    {
+        printf("Error: allocation failed for the threads\n");
+        exit(1);
+    }
+    for (long t = 0; t < nbThreads; t++)
+    {
+        workers[t].strategy = strategy;
+        workers[t].seed = seed;
+        workers[t].first = games * t / nbThreads;
+        workers[t].last = games * (t + 1) / nbThreads;
+        if (pthread_create(&threads[t], NULL, runWorker, &workers[t]) != 0)
+        {
+            printf("Error: the thread can't be created\n");
+            exit(1);
+        }
+    }
+
+    // the counters are integers, so the sum doesn't depend on the order
+    Stats *total = calloc(NB_TARGETINGS, sizeof(Stats));
+    if (total == NULL)
+    {
+        printf("Error: allocation failed for the stats\n");
+        exit(1);
+    }
+    for (long t = 0; t < nbThreads; t++)
+    {
+        pthread_join(threads[t], NULL);
+        for (int a = 0; a < NB_TARGETINGS; a++)
+        {
+            total[a].games += workers[t].stats[a].games;
+            total[a].shots += workers[t].stats[a].shots;
+            for (int i = 0; i <= NB_CASES; i++)
+            {
+                total[a].sunkAt[i] += workers[t].stats[a].sunkAt[i];
+            }
+            for (int i = 0; i < NB_CASES; i++)
+            {
+                total[a].hits[i] += workers[t].stats[a].hits[i];
+                total[a].shotsPerCase[i] += workers[t].stats[a].shotsPerCase[i];
+            }
+        }
+    }
+
+    printf("Placement %s, %llu parties, graine %llu, %ld threads\n\n", strategyNames[strategy],
+           (unsigned long long)games, (unsigned long long)seed, nbThreads);
+    for (int a = 0; a < NB_TARGETINGS; a++)
+    {
+        displayStats(a, &total[a]);
+    }
+
+    free(total);
+    free(threads);
+    free(workers);
+    return 0;
+}
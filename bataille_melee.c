@@ -0,0 +1,237 @@
+/**
+ * @file bataille_melee.c
+ * @brief Free-for-all game between computer players on a shared board.
+ *
+ * Every turn, each player left fires at a random case not shot yet (never on
+ * its own boats), then the turn is resolved on all the cores. Prints the
+ * eliminations, the winner and the time spent resolving the turns. With -c the
+ * game is played again on one thread: the outcomes of every shot must be the
+ * same, and the times give the speedup of the threads.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include "melee.h"
+
+#define MAX_TRIES 8 // draws before a player fires even on its own boat
+
+/**
+ * @struct MeleeSummary
+ * @brief Represents the result of a game played by playMelee.
+ */
+typedef struct
+{
+    int winner;        /**< Id of the winner, -1 if none. */
+    int turns;         /**< Number of turns played. */
+    long long shots;   /**< Number of shots resolved. */
+    double resolving;  /**< Time spent resolving the turns, in seconds. */
+    uint64_t checksum; /**< Hash of the outcomes of every shot, in order. */
+} MeleeSummary;
+
+/*!
+ * \brief function to give the current time
+ * \return the time in seconds
+ */
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/*!
+ * \brief function to play a game until at most one player is left
+ * \param size the size of the shared board
+ * \param nbPlayers the number of players
+ * \param nbThreads the number of threads resolving a turn, 0 for one per core
+ * \param seed the seed of the game
+ * \param verbose 1 to print the eliminations, 0 otherwise
+ * \param summary the result of the game, filled by the function
+ * \return STATUS_OK, or the status of the failure
+ */
+static Status playMelee(int size, int nbPlayers, int nbThreads, uint64_t seed, int verbose, MeleeSummary *summary)
+{
+    MeleeGame *game = NULL;
+    Status status = createMeleeGame(size, nbPlayers, nbThreads, seed, &game);
+    if (status != STATUS_OK)
+    {
+        return status;
+    }
+
+    // cases not shot yet, removed as they are shot
+    int nbCases = size * size;
+    int *remaining = malloc(nbCases * sizeof(int));
+    int *position = malloc(nbCases * sizeof(int));
+    MeleeShot *shots = malloc(nbPlayers * sizeof(MeleeShot));
+    MeleeOutcome *outcomes = malloc(nbPlayers * sizeof(MeleeOutcome));
+    if (remaining == NULL || position == NULL || shots == NULL || outcomes == NULL)
+    {
+        free(remaining);
+        free(position);
+        free(shots);
+        free(outcomes);
+        freeMeleeGame(game);
+        return STATUS_NO_MEMORY;
+    }
+    for (int cell = 0; cell < nbCases; cell++)
+    {
+        remaining[cell] = cell;
+        position[cell] = cell;
+    }
+    int nbRemaining = nbCases;
+    Rng rng;
+    seedRandom(&rng, seed ^ 0x5DEECE66DULL);
+    summary->resolving = 0.0;
+    summary->shots = 0;
+    // FNV-1a offset basis
+    summary->checksum = 0xCBF29CE484222325ULL;
+
+    while (!isMeleeOver(game) && nbRemaining > 0)
+    {
+        int nbShots = 0;
+        for (int player = 0; player < nbPlayers; player++)
+        {
+            if (!isPlayerAlive(game, player))
+            {
+                continue;
+            }
+            int cell = 0;
+            for (int tries = 0; tries < MAX_TRIES; tries++)
+            {
+                cell = remaining[randomBelow(&rng, nbRemaining)];
+                if (findOwner(game, cell / size, cell % size, NULL) != player)
+                {
+                    break;
+                }
+            }
+            MeleeShot shot = {player, cell / size, cell % size};
+            shots[nbShots++] = shot;
+        }
+
+        double start = now();
+        status = resolveTurn(game, shots, nbShots, outcomes);
+        summary->resolving += now() - start;
+        if (status != STATUS_OK)
+        {
+            break;
+        }
+        summary->shots += nbShots;
+
+        for (int i = 0; i < nbShots; i++)
+        {
+            int cell = shots[i].x * size + shots[i].y;
+            // remove the case from the cases not shot yet
+            if (position[cell] != -1)
+            {
+                int last = remaining[--nbRemaining];
+                remaining[position[cell]] = last;
+                position[last] = position[cell];
+                position[cell] = -1;
+            }
+            uint64_t word = (uint64_t)outcomes[i].type << 48 ^ (uint64_t)(outcomes[i].victim + 1) << 16 ^
+                            (uint64_t)(outcomes[i].boatId + 1);
+            summary->checksum = (summary->checksum ^ word) * 0x100000001B3ULL;
+            if (verbose && outcomes[i].type == SHOT_FLEET_DESTROYED)
+            {
+                printf("Tour %d : le joueur %d est éliminé par le joueur %d (%d restants)\n", game->turn,
+                       outcomes[i].victim, shots[i].player, game->playersAlive);
+            }
+        }
+    }
+    summary->winner = meleeWinner(game);
+    summary->turns = game->turn;
+
+    free(remaining);
+    free(position);
+    free(shots);
+    free(outcomes);
+    freeMeleeGame(game);
+    return status;
+}
+
+int main(int argc, char **argv)
+{
+    int nbPlayers = 100;
+    int nbThreads = 0;
+    int size = 0;
+    int check = 0;
+    uint64_t seed = (uint64_t)time(NULL);
+    int option;
+    while ((option = getopt(argc, argv, "j:t:n:s:c")) != -1)
+    {
+        switch (option)
+        {
+        case 'j':
+            nbPlayers = atoi(optarg);
+            break;
+        case 't':
+            nbThreads = atoi(optarg);
+            break;
+        case 'n':
+            size = atoi(optarg);
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 10);
+            break;
+        case 'c':
+            check = 1;
+            break;
+        default:
+            printf("Usage: %s [-j joueurs] [-t threads] [-n taille] [-s graine] [-c]\n", argv[0]);
+            return 1;
+        }
+    }
+    // smallest board leaving room enough for every fleet
+    if (size == 0)
+    {
+        size = SIZE;
+        while ((int64_t)size * size < (int64_t)MELEE_CASES_PER_PLAYER * nbPlayers)
+        {
+            size++;
+        }
+    }
+
+    printf("%d joueurs sur un plateau de %d x %d (graine %llu)\n", nbPlayers, size, size, (unsigned long long)seed);
+    MeleeSummary summary;
+    Status status = playMelee(size, nbPlayers, nbThreads, seed, !check, &summary);
+    if (status != STATUS_OK)
+    {
+        printf("Error: %s\n", statusMessage(status));
+        return 1;
+    }
+    if (summary.winner != -1)
+    {
+        printf("Le joueur %d gagne en %d tours\n", summary.winner, summary.turns);
+    }
+    else
+    {
+        printf("Aucun gagnant après %d tours\n", summary.turns);
+    }
+    printf("%lld tirs résolus en %.3f s (%.0f tirs/s)\n", summary.shots, summary.resolving,
+           summary.resolving > 0.0 ? summary.shots / summary.resolving : 0.0);
+    if (!check)
+    {
+        return 0;
+    }
+
+    // the same game on one thread must give the same outcomes
+    MeleeSummary alone;
+    status = playMelee(size, nbPlayers, 1, seed, 0, &alone);
+    if (status != STATUS_OK)
+    {
+        printf("Error: %s\n", statusMessage(status));
+        return 1;
+    }
+    printf("Sur 1 thread : %lld tirs résolus en %.3f s, accélération %.2f\n", alone.shots, alone.resolving,
+           summary.resolving > 0.0 ? alone.resolving / summary.resolving : 0.0);
+    if (alone.checksum != summary.checksum || alone.winner != summary.winner || alone.turns != summary.turns)
+    {
+        printf("Les résultats diffèrent selon le nombre de threads\n");
+        return 1;
+    }
+    printf("Résultats identiques\n");
+    return 0;
+}
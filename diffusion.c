@@ -0,0 +1,549 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "diffusion.h"
+
+#define STREAM_MAGIC 0x3158554C46464944ULL // "DIFFLUX1"
+#define NEW_GAME 7                         // type of the delta starting a game
+#define MAX_RESYNC_TRIES 1000              // reads of a keyframe being written before giving up
+
+/**
+ * @struct StreamHeader
+ * @brief Header at the start of the stream file, followed by the ring of deltas.
+ *
+ * A delta is one word: bits 0-31 the low bits of its sequence number, 32-39 x,
+ * 40-47 y, 48 the side, 49-51 the type of the event, 52-55 the boat + 1. The
+ * sequence number tells a reader if the slot was written again since.
+ */
+typedef struct
+{
+    uint64_t magic;                     /**< STREAM_MAGIC, written last when the file is created. */
+    uint32_t size;                      /**< Size of the boards. */
+    uint32_t capacity;                  /**< Number of deltas of the ring. */
+    uint64_t head;                      /**< Number of deltas written since the file was created. */
+    uint64_t keyframeLock;              /**< Sequence lock of the keyframe, odd while it is written. */
+    uint64_t keyframeNext;              /**< Sequence number of the first delta not in the keyframe. */
+    uint8_t sunkMask[2];                /**< Sunk boats of each side in the keyframe. */
+    uint8_t padding[22];                /**< Unused, keeps the keyframe aligned on 64 bytes. */
+    uint8_t cases[2][STREAM_MAX_CASES]; /**< Cases of each side in the keyframe. */
+} StreamHeader;
+
+/**
+ * @struct BoardsCopy
+ * @brief Copy of both boards, kept by the writer and by each reader.
+ */
+typedef struct
+{
+    int size;                           /**< Size of the boards. */
+    uint8_t cases[2][STREAM_MAX_CASES]; /**< Cases of each side. */
+    uint8_t sunkMask[2];                /**< Sunk boats of each side. */
+} BoardsCopy;
+
+/**
+ * @struct BroadcastSide
+ * @brief User data of the shot listener of one side.
+ */
+typedef struct
+{
+    Broadcast *broadcast; /**< The stream. */
+    int side;             /**< PLAYER_SIDE or COMPUTER_SIDE. */
+    const Fleet *fleet;   /**< The fleet placed on the board. */
+} BroadcastSide;
+
+struct Broadcast
+{
+    int fd;                 /**< File descriptor of the stream. */
+    StreamHeader *header;   /**< Mapping of the stream. */
+    uint64_t *ring;         /**< Ring of deltas, after the header. */
+    size_t bytes;           /**< Size of the mapping. */
+    BoardsCopy boards;      /**< State of the game, copied into each keyframe. */
+    BroadcastSide sides[2]; /**< User data of the listeners of both sides. */
+};
+
+struct Spectator
+{
+    int fd;                     /**< File descriptor of the stream. */
+    const StreamHeader *header; /**< Mapping of the stream, read only. */
+    const uint64_t *ring;       /**< Ring of deltas, after the header. */
+    size_t bytes;               /**< Size of the mapping. */
+    uint64_t next;              /**< Sequence number of the next delta to read. */
+    BoardsCopy boards;          /**< State of the game seen by the spectator. */
+};
+
+/*!
+ * \brief function to give the size of the stream file
+ * \return the size in bytes
+ */
+static size_t streamBytes(void)
+{
+    return sizeof(StreamHeader) + STREAM_CAPACITY * sizeof(uint64_t);
+}
+
+/*!
+ * \brief function to apply a delta to a copy of the boards
+ * \param boards the copy
+ * \param delta the delta
+ */
+static void applyDelta(BoardsCopy *boards, const StreamDelta *delta)
+{
+    uint8_t *target = &boards->cases[delta->side][delta->x * boards->size + delta->y];
+    if (delta->type == SHOT_MISS)
+    {
+        *target = WATER_SHOT;
+    }
+    else if (delta->type != SHOT_ALREADY_FIRED)
+    {
+        *target = WRECK;
+    }
+    if ((delta->type == SHOT_SUNK || delta->type == SHOT_FLEET_DESTROYED) && delta->boatId >= 0)
+    {
+        boards->sunkMask[delta->side] |= (uint8_t)(1u << delta->boatId);
+    }
+}
+
+/*!
+ * \brief function to write the copy of the boards as the keyframe
+ * \param broadcast the stream
+ * \param next the sequence number of the first delta not in the keyframe
+ */
+static void writeKeyframe(Broadcast *broadcast, uint64_t next)
+{
+    StreamHeader *header = broadcast->header;
+    uint64_t lock = header->keyframeLock;
+    // odd while writing: the readers copying at the same time try again
+    __atomic_store_n(&header->keyframeLock, lock + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(header->cases, broadcast->boards.cases, sizeof(header->cases));
+    memcpy(header->sunkMask, broadcast->boards.sunkMask, sizeof(header->sunkMask));
+    header->keyframeNext = next;
+    __atomic_store_n(&header->keyframeLock, lock + 2, __ATOMIC_RELEASE);
+}
+
+/*!
+ * \brief function to append a delta to the ring
+ * \param broadcast the stream
+ * \param side the side of the shot
+ * \param x the x position of the shot
+ * \param y the y position of the shot
+ * \param type the type of the event
+ * \param boatId the index of the boat concerned, -1 if none
+ */
+static void publishDelta(Broadcast *broadcast, int side, int x, int y, int type, int boatId)
+{
+    StreamHeader *header = broadcast->header;
+    uint64_t seq = header->head;
+    uint64_t word = (uint32_t)seq | (uint64_t)(x & 0xFF) << 32 | (uint64_t)(y & 0xFF) << 40 |
+                    (uint64_t)(side & 1) << 48 | (uint64_t)(type & 7) << 49 | (uint64_t)((boatId + 1) & 0xF) << 52;
+    // the slot first, then the head: a reader seeing the head sees the slot
+    __atomic_store_n(&broadcast->ring[seq & (STREAM_CAPACITY - 1)], word, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->head, seq + 1, __ATOMIC_RELEASE);
+    if ((seq + 1) % KEYFRAME_INTERVAL == 0)
+    {
+        writeKeyframe(broadcast, seq + 1);
+    }
+}
+
+/*!
+ * \brief listener writing the shot events of a side to the stream
+ * \param event the event
+ * \param userData the side
+ */
+static void broadcastShot(const ShotEvent *event, void *userData)
+{
+    BroadcastSide *source = userData;
+    // a shot fired twice changes nothing
+    if (event->type == SHOT_ALREADY_FIRED)
+    {
+        return;
+    }
+    // one delta per shot: a hit sinking the boat is followed by SHOT_SUNK, and
+    // the sinking of the last boat by SHOT_FLEET_DESTROYED, only the last is written
+    if (event->type == SHOT_HIT && isBoatWrecked(source->fleet, event->boatId))
+    {
+        return;
+    }
+    if (event->type == SHOT_SUNK && isFleetWrecked(source->fleet))
+    {
+        return;
+    }
+    StreamDelta delta = {source->side, event->x, event->y, event->type, event->boatId};
+    applyDelta(&source->broadcast->boards, &delta);
+    publishDelta(source->broadcast, source->side, event->x, event->y, event->type, event->boatId);
+}
+
+/*!
+ * \brief function to open a stream for writing
+ * \param path the path of the stream, without extension
+ * \param size the size of the boards
+ * \return the stream, NULL on failure
+ */
+Broadcast *openBroadcast(const char *path, int size)
+{
+    // check if the parameters are correct
+    if (path == NULL || size < 1 || (int64_t)size * size > STREAM_MAX_CASES)
+    {
+        return NULL;
+    }
+    Broadcast *broadcast = calloc(1, sizeof(Broadcast));
+    if (broadcast == NULL)
+    {
+        return NULL;
+    }
+    size_t length = strlen(path) + strlen(".flux") + 1;
+    char *name = malloc(length);
+    if (name == NULL)
+    {
+        free(broadcast);
+        return NULL;
+    }
+    snprintf(name, length, "%s.flux", path);
+    broadcast->fd = open(name, O_RDWR | O_CREAT, 0644);
+    free(name);
+    broadcast->bytes = streamBytes();
+    // one writer at a time: the lock is held until the file is closed, a game
+    // started while another one is streaming plays without spectators
+    if (broadcast->fd == -1 || flock(broadcast->fd, LOCK_EX | LOCK_NB) != 0)
+    {
+        closeBroadcast(broadcast);
+        return NULL;
+    }
+    // the file is never shrunk: a spectator reading it would crash
+    struct stat info;
+    if (fstat(broadcast->fd, &info) != 0 ||
+        ((size_t)info.st_size < broadcast->bytes && ftruncate(broadcast->fd, (off_t)broadcast->bytes) != 0))
+    {
+        closeBroadcast(broadcast);
+        return NULL;
+    }
+    void *mapping = mmap(NULL, broadcast->bytes, PROT_READ | PROT_WRITE, MAP_SHARED, broadcast->fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        closeBroadcast(broadcast);
+        return NULL;
+    }
+    broadcast->header = mapping;
+    broadcast->ring = (uint64_t *)(broadcast->header + 1);
+
+    // a stream of another size is started over; the magic is written last so
+    // that a spectator never reads a header being set up
+    StreamHeader *header = broadcast->header;
+    if (header->magic != STREAM_MAGIC || header->size != (uint32_t)size || header->capacity != STREAM_CAPACITY)
+    {
+        __atomic_store_n(&header->magic, 0, __ATOMIC_RELEASE);
+        header->size = (uint32_t)size;
+        header->capacity = STREAM_CAPACITY;
+        header->keyframeNext = header->head;
+        __atomic_store_n(&header->magic, STREAM_MAGIC, __ATOMIC_RELEASE);
+    }
+    broadcast->boards.size = size;
+    for (int side = 0; side < 2; side++)
+    {
+        broadcast->sides[side].broadcast = broadcast;
+        broadcast->sides[side].side = side;
+    }
+    return broadcast;
+}
+
+/*!
+ * \brief function to start a new game on the stream
+ * \param broadcast the stream
+ * \param playerBoard the player's board
+ * \param computerBoard the computer's board
+ * \return 1 if the game was started, 0 otherwise
+ */
+int startBroadcast(Broadcast *broadcast, const Board *playerBoard, const Board *computerBoard)
+{
+    // check if the parameters are correct
+    if (broadcast == NULL || playerBoard == NULL || computerBoard == NULL)
+    {
+        return 0;
+    }
+    int size = broadcast->boards.size;
+    if (playerBoard->size != size || computerBoard->size != size)
+    {
+        return 0;
+    }
+    const Board *boards[2] = {playerBoard, computerBoard};
+    for (int side = 0; side < 2; side++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            for (int y = 0; y < size; y++)
+            {
+                // the boats not hit yet stay hidden, as on the computer's board
+                // shown to the player: the stream file can be read by anyone
+                CaseType type = getCase(boards[side], x, y);
+                broadcast->boards.cases[side][x * size + y] = (uint8_t)(type == BOAT ? WATER : type);
+            }
+        }
+        broadcast->boards.sunkMask[side] = 0;
+    }
+    // the keyframe first: a spectator reading the new game delta finds it
+    uint64_t seq = broadcast->header->head;
+    writeKeyframe(broadcast, seq + 1);
+    publishDelta(broadcast, 0, 0, 0, NEW_GAME, -1);
+    return 1;
+}
+
+/*!
+ * \brief function to write the shot events of a board to the stream
+ * \param broadcast the stream
+ * \param board the board
+ * \param fleet the fleet placed on the board
+ * \param side PLAYER_SIDE or COMPUTER_SIDE
+ * \return 1 if the listener was added, 0 otherwise
+ */
+int broadcastBoard(Broadcast *broadcast, Board *board, const Fleet *fleet, int side)
+{
+    // check if the parameters are correct
+    if (broadcast == NULL || board == NULL || fleet == NULL || (side != PLAYER_SIDE && side != COMPUTER_SIDE))
+    {
+        return 0;
+    }
+    broadcast->sides[side].fleet = fleet;
+    return addShotListener(board, broadcastShot, &broadcast->sides[side]) == STATUS_OK;
+}
+
+/*!
+ * \brief function to close a stream
+ * \param broadcast the stream, may be NULL
+ */
+void closeBroadcast(Broadcast *broadcast)
+{
+    if (broadcast == NULL)
+    {
+        return;
+    }
+    if (broadcast->header != NULL)
+    {
+        msync(broadcast->header, broadcast->bytes, MS_SYNC);
+        munmap(broadcast->header, broadcast->bytes);
+    }
+    if (broadcast->fd != -1)
+    {
+        close(broadcast->fd);
+    }
+    free(broadcast);
+}
+
+/*!
+ * \brief function to load the last keyframe into the copy of a spectator
+ * \param spectator the spectator
+ * \return 1 if the keyframe was loaded, 0 if it was being written at each try
+ */
+static int loadKeyframe(Spectator *spectator)
+{
+    const StreamHeader *header = spectator->header;
+    for (int tries = 0; tries < MAX_RESYNC_TRIES; tries++)
+    {
+        uint64_t before = __atomic_load_n(&header->keyframeLock, __ATOMIC_ACQUIRE);
+        if (before & 1)
+        {
+            continue;
+        }
+        BoardsCopy boards = spectator->boards;
+        memcpy(boards.cases, header->cases, sizeof(boards.cases));
+        memcpy(boards.sunkMask, header->sunkMask, sizeof(boards.sunkMask));
+        uint64_t next = header->keyframeNext;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        // the copy is good only if the writer didn't touch the keyframe meanwhile
+        if (__atomic_load_n(&header->keyframeLock, __ATOMIC_RELAXED) == before)
+        {
+            spectator->boards = boards;
+            spectator->next = next;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*!
+ * \brief function to open a stream for reading
+ * \param path the path of the stream, without extension
+ * \return the spectator, NULL on failure
+ */
+Spectator *openSpectator(const char *path)
+{
+    // check if the path is correct
+    if (path == NULL)
+    {
+        return NULL;
+    }
+    Spectator *spectator = calloc(1, sizeof(Spectator));
+    if (spectator == NULL)
+    {
+        return NULL;
+    }
+    size_t length = strlen(path) + strlen(".flux") + 1;
+    char *name = malloc(length);
+    if (name == NULL)
+    {
+        free(spectator);
+        return NULL;
+    }
+    snprintf(name, length, "%s.flux", path);
+    spectator->fd = open(name, O_RDONLY);
+    free(name);
+    spectator->bytes = streamBytes();
+    struct stat info;
+    if (spectator->fd == -1 || fstat(spectator->fd, &info) != 0 || (size_t)info.st_size < spectator->bytes)
+    {
+        closeSpectator(spectator);
+        return NULL;
+    }
+    void *mapping = mmap(NULL, spectator->bytes, PROT_READ, MAP_SHARED, spectator->fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        closeSpectator(spectator);
+        return NULL;
+    }
+    spectator->header = mapping;
+    spectator->ring = (const uint64_t *)(spectator->header + 1);
+
+    const StreamHeader *header = spectator->header;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != STREAM_MAGIC || header->capacity != STREAM_CAPACITY ||
+        header->size < 1 || (uint64_t)header->size * header->size > STREAM_MAX_CASES)
+    {
+        closeSpectator(spectator);
+        return NULL;
+    }
+    spectator->boards.size = (int)header->size;
+    // a late joiner starts from the last keyframe
+    if (!loadKeyframe(spectator))
+    {
+        closeSpectator(spectator);
+        return NULL;
+    }
+    return spectator;
+}
+
+/*!
+ * \brief function to apply the new deltas of the stream
+ * \param spectator the spectator
+ * \param last the last shot event applied, may be NULL
+ * \return the number of changes, 0 if nothing new
+ */
+int pollSpectator(Spectator *spectator, StreamDelta *last)
+{
+    // check if the spectator is correct
+    if (spectator == NULL)
+    {
+        return 0;
+    }
+    const StreamHeader *header = spectator->header;
+    int changes = 0;
+    uint64_t head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+    // too far behind, the ring was written over: start again from the keyframe
+    if (head - spectator->next > STREAM_CAPACITY && loadKeyframe(spectator))
+    {
+        changes++;
+    }
+    while (spectator->next < head)
+    {
+        uint64_t word = __atomic_load_n(&spectator->ring[spectator->next & (STREAM_CAPACITY - 1)], __ATOMIC_ACQUIRE);
+        int type = (int)(word >> 49) & 7;
+        if ((uint32_t)word != (uint32_t)spectator->next || type == NEW_GAME)
+        {
+            // written over while reading, or a new game: the keyframe is newer
+            uint64_t before = spectator->next;
+            if (!loadKeyframe(spectator) || spectator->next <= before)
+            {
+                break;
+            }
+            changes++;
+            continue;
+        }
+        StreamDelta delta;
+        delta.x = (int)(word >> 32) & 0xFF;
+        delta.y = (int)(word >> 40) & 0xFF;
+        delta.side = (int)(word >> 48) & 1;
+        delta.type = (ShotEventType)type;
+        delta.boatId = (int)((word >> 52) & 0xF) - 1;
+        if (delta.x < spectator->boards.size && delta.y < spectator->boards.size)
+        {
+            applyDelta(&spectator->boards, &delta);
+            if (last != NULL)
+            {
+                *last = delta;
+            }
+        }
+        spectator->next++;
+        changes++;
+    }
+    return changes;
+}
+
+/*!
+ * \brief function to give the size of the boards of the stream
+ * \param spectator the spectator
+ * \return the size of the boards
+ */
+int spectatorSize(const Spectator *spectator)
+{
+    return spectator == NULL ? 0 : spectator->boards.size;
+}
+
+/*!
+ * \brief function to give the type of a case
+ * \param spectator the spectator
+ * \param side PLAYER_SIDE or COMPUTER_SIDE
+ * \param x the x position of the case
+ * \param y the y position of the case
+ * \return the type of the case, WATER when the case is outside the board
+ */
+CaseType spectatorCase(const Spectator *spectator, int side, int x, int y)
+{
+    if (spectator == NULL || (side != PLAYER_SIDE && side != COMPUTER_SIDE))
+    {
+        return WATER;
+    }
+    int size = spectator->boards.size;
+    if (x < 0 || x >= size || y < 0 || y >= size)
+    {
+        return WATER;
+    }
+    return (CaseType)spectator->boards.cases[side][x * size + y];
+}
+
+/*!
+ * \brief function to give the boats sunk on a side
+ * \param spectator the spectator
+ * \param side PLAYER_SIDE or COMPUTER_SIDE
+ * \return the sunk boats, one bit per boat
+ */
+int spectatorSunk(const Spectator *spectator, int side)
+{
+    if (spectator == NULL || (side != PLAYER_SIDE && side != COMPUTER_SIDE))
+    {
+        return 0;
+    }
+    return spectator->boards.sunkMask[side];
+}
+
+/*!
+ * \brief function to close a spectator
+ * \param spectator the spectator, may be NULL
+ */
+void closeSpectator(Spectator *spectator)
+{
+    if (spectator == NULL)
+    {
+        return;
+    }
+    if (spectator->header != NULL)
+    {
+        munmap((void *)spectator->header, spectator->bytes);
+    }
+    if (spectator->fd != -1)
+    {
+        close(spectator->fd);
+    }
+    free(spectator);
+}
@@ -0,0 +1,137 @@
+/**
+ * @file diffusion.h
+ * @brief Header file of the live stream of a game to the spectators.
+ *
+ * The game writes one compact delta per shot (side, case, final outcome, boat)
+ * into a ring buffer in a shared memory-mapped file (<path>.flux), and a full
+ * copy of both boards (a keyframe) every KEYFRAME_INTERVAL deltas. Each delta
+ * is one 64 bits word written once, so any number of spectators map the same
+ * file and read the same bytes: nothing is encoded or copied per spectator.
+ * A spectator joining late, or falling more than STREAM_CAPACITY deltas behind,
+ * starts again from the last keyframe, protected by a sequence lock. Only one
+ * game writes to a stream at a time, and the boats not hit yet are never
+ * written, so the spectators see what each shooter sees.
+ */
+
+#ifndef DIFFUSION_H
+#define DIFFUSION_H
+
+#include <stdint.h>
+#include "fonctions.h"
+
+#define STREAM_CAPACITY 1024   // number of deltas kept in the ring, a power of 2
+#define KEYFRAME_INTERVAL 64   // number of deltas between two keyframes
+#define STREAM_MAX_CASES 256   // largest number of cases of a board streamed
+#define PLAYER_SIDE 0          // side of the player's board
+#define COMPUTER_SIDE 1        // side of the computer's board
+
+/**
+ * @struct StreamDelta
+ * @brief Represents a shot event read from the stream.
+ */
+typedef struct
+{
+    int side;           /**< PLAYER_SIDE or COMPUTER_SIDE. */
+    int x;              /**< X position of the shot. */
+    int y;              /**< Y position of the shot. */
+    ShotEventType type; /**< Type of the event. */
+    int boatId;         /**< Index of the boat concerned, -1 if none. */
+} StreamDelta;
+
+/**
+ * @struct Broadcast
+ * @brief Represents the writing end of a stream (opaque).
+ */
+typedef struct Broadcast Broadcast;
+
+/**
+ * @struct Spectator
+ * @brief Represents a reader of a stream and its copy of the boards (opaque).
+ */
+typedef struct Spectator Spectator;
+
+/**
+ * @brief Opens a stream for writing, creating its file if needed.
+ *
+ * The deltas of the previous games are kept, so the spectators already
+ * watching go on reading the same stream.
+ * @param path The path of the stream, without extension.
+ * @param size The size of the boards, at most STREAM_MAX_CASES cases.
+ * @return A pointer to the stream, NULL if the parameters are not correct, the
+ *         file can't be opened or another game is already writing to it.
+ */
+Broadcast *openBroadcast(const char *path, int size);
+
+/**
+ * @brief Starts a new game on the stream: writes a keyframe of both boards,
+ *        the boats not hit yet written as WATER.
+ * @param broadcast The stream.
+ * @param playerBoard The player's board.
+ * @param computerBoard The computer's board.
+ * @return 1 if the game was started, 0 otherwise.
+ */
+int startBroadcast(Broadcast *broadcast, const Board *playerBoard, const Board *computerBoard);
+
+/**
+ * @brief Writes the outcome of every shot on a board to the stream, through a shot listener.
+ * @param broadcast The stream.
+ * @param board The board.
+ * @param fleet The fleet placed on the board, read to keep one delta per shot.
+ * @param side PLAYER_SIDE or COMPUTER_SIDE.
+ * @return 1 if the listener was added, 0 otherwise.
+ */
+int broadcastBoard(Broadcast *broadcast, Board *board, const Fleet *fleet, int side);
+
+/**
+ * @brief Writes the stream to the disk and closes it.
+ * @param broadcast The stream, may be NULL.
+ */
+void closeBroadcast(Broadcast *broadcast);
+
+/**
+ * @brief Opens a stream for reading, starting from its last keyframe.
+ * @param path The path of the stream, without extension.
+ * @return A pointer to the spectator, NULL if the path is NULL or there is no stream yet.
+ */
+Spectator *openSpectator(const char *path);
+
+/**
+ * @brief Applies the deltas written since the last call to the copy of the boards.
+ * @param spectator The spectator.
+ * @param last The last shot event applied, left unchanged if there is none; may be NULL.
+ * @return The number of changes (deltas applied and keyframes loaded), 0 if nothing new.
+ */
+int pollSpectator(Spectator *spectator, StreamDelta *last);
+
+/**
+ * @brief Gives the size of the boards of the stream.
+ * @param spectator The spectator.
+ * @return The size of the boards.
+ */
+int spectatorSize(const Spectator *spectator);
+
+/**
+ * @brief Gives the type of a case, as known by the spectator.
+ * @param spectator The spectator.
+ * @param side PLAYER_SIDE or COMPUTER_SIDE.
+ * @param x The x position of the case.
+ * @param y The y position of the case.
+ * @return The type of the case, WATER when the case is outside the board.
+ */
+CaseType spectatorCase(const Spectator *spectator, int side, int x, int y);
+
+/**
+ * @brief Gives the boats sunk on a side, as known by the spectator.
+ * @param spectator The spectator.
+ * @param side PLAYER_SIDE or COMPUTER_SIDE.
+ * @return The sunk boats, one bit per boat.
+ */
+int spectatorSunk(const Spectator *spectator, int side);
+
+/**
+ * @brief Closes a spectator.
+ * @param spectator The spectator, may be NULL.
+ */
+void closeSpectator(Spectator *spectator);
+
+#endif // DIFFUSION_H
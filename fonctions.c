@@ -1,56 +1,325 @@
+#include <string.h>
 #include "fonctions.h"
 
+/*!
+ * \brief function to describe a status
+ * \param status the status
+ * \return a constant string describing the status
+ */
+const char *statusMessage(Status status)
+{
+    switch (status)
+    {
+    case STATUS_OK:
+        return "no error";
+    case STATUS_INVALID_ARGUMENT:
+        return "a parameter is not correct";
+    case STATUS_OUT_OF_BOARD:
+        return "the position is outside the board";
+    case STATUS_CANT_PLACE:
+        return "the boat can't be placed";
+    case STATUS_FULL:
+        return "there is no room left";
+    case STATUS_NO_MEMORY:
+        return "allocation failed";
+    default:
+        return "unknown status";
+    }
+}
+
+/*!
+ * \brief function to seed a random generator
+ * \param rng the generator
+ * \param seed the seed
+ */
+void seedRandom(Rng *rng, uint64_t seed)
+{
+    rng->state = seed;
+}
+
+/*!
+ * \brief function to draw a random 64 bits number (splitmix64)
+ * \param rng the generator
+ * \return the number
+ */
+uint64_t nextRandom(Rng *rng)
+{
+    uint64_t z = (rng->state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/*!
+ * \brief function to draw a random number below a bound
+ * \param rng the generator
+ * \param bound the bound
+ * \return a number between 0 and bound - 1
+ */
+int randomBelow(Rng *rng, int bound)
+{
+    return (int)(((nextRandom(rng) >> 32) * (uint64_t)bound) >> 32);
+}
+
 /*!
  * \brief function to create a board
  * \param size the size of the board
- * \return the board
+ * \param board the board created
+ * \return STATUS_OK, STATUS_INVALID_ARGUMENT or STATUS_NO_MEMORY
  */
-Board *createBoard(int size)
+Status createBoard(int size, Board **board)
 {
-    // check if the size is correct
-    if (size != SIZE)
+    // check if the parameters are correct
+    if (size < 1 || size > MAX_SIZE || board == NULL)
     {
-        printf("Error: the size of the board is not correct\n");
-        exit(1);
+        return STATUS_INVALID_ARGUMENT;
     }
     // allocation of the board
-    Board *board = malloc(sizeof(Board));
+    Board *created = malloc(sizeof(Board));
+    if (created == NULL)
+    {
+        return STATUS_NO_MEMORY;
+    }
+
+    created->size = size;
+    created->nbListeners = 0;
+
+    // no tile yet: every case is WATER until it is written
+    created->nbTiles = 0;
+    created->tilesCapacity = 4;
+    created->indexCapacity = 8;
+    created->tiles = malloc(created->tilesCapacity * sizeof(Tile));
+    created->tileIndex = malloc(created->indexCapacity * sizeof(int));
+    if (created->tiles == NULL || created->tileIndex == NULL)
+    {
+        free(created->tiles);
+        free(created->tileIndex);
+        free(created);
+        return STATUS_NO_MEMORY;
+    }
+    for (int i = 0; i < created->indexCapacity; i++)
+    {
+        created->tileIndex[i] = -1;
+    }
+    *board = created;
+    return STATUS_OK;
+}
+
+/*!
+ * \brief function to reset all the cases of a board to WATER
+ * \param board the board
+ */
+void clearBoard(Board *board)
+{
     if (board == NULL)
     {
-        printf("Error: allocation failed for board\n");
-        exit(1);
+        return;
     }
+    // the tiles and the index stay allocated for the next game
+    board->nbTiles = 0;
+    for (int i = 0; i < board->indexCapacity; i++)
+    {
+        board->tileIndex[i] = -1;
+    }
+}
 
-    board->size = size;
+/*!
+ * \brief function to give the first slot of the index to look at for a tile
+ * \param board the board
+ * \param tileX the x position of the tile
+ * \param tileY the y position of the tile
+ * \return the slot
+ */
+static int hashTile(const Board *board, int tileX, int tileY)
+{
+    uint64_t key = ((uint64_t)(uint32_t)tileX << 32) | (uint32_t)tileY;
+    key *= 0x9E3779B97F4A7C15ULL;
+    return (int)(key >> 32) & (board->indexCapacity - 1);
+}
+
+/*!
+ * \brief function to find a tile
+ * \param board the board
+ * \param tileX the x position of the tile
+ * \param tileY the y position of the tile
+ * \return the position of the tile in board->tiles, -1 if the tile is not stored
+ */
+static int findTile(const Board *board, int tileX, int tileY)
+{
+    // linear probing until the tile or an empty slot
+    for (int slot = hashTile(board, tileX, tileY);; slot = (slot + 1) & (board->indexCapacity - 1))
+    {
+        int tile = board->tileIndex[slot];
+        if (tile == -1 || (board->tiles[tile].x == tileX && board->tiles[tile].y == tileY))
+        {
+            return tile;
+        }
+    }
+}
 
-    board->matrix = malloc(size * sizeof(int *));
-    if (board->matrix == NULL)
+/*!
+ * \brief function to double the number of slots of the index
+ * \param board the board
+ * \return STATUS_OK or STATUS_NO_MEMORY
+ */
+static Status growIndex(Board *board)
+{
+    int *index = malloc(2 * board->indexCapacity * sizeof(int));
+    if (index == NULL)
+    {
+        return STATUS_NO_MEMORY;
+    }
+    free(board->tileIndex);
+    board->tileIndex = index;
+    board->indexCapacity *= 2;
+    for (int i = 0; i < board->indexCapacity; i++)
     {
-        printf("Error: allocation failed for matrix creation\n");
-        free(board);
-        exit(1);
+        board->tileIndex[i] = -1;
     }
-    // allocation of the matrix and set all the cases to WATER
-    for (int i = 0; i < size; i++)
+    // put back every tile in the new index
+    for (int tile = 0; tile < board->nbTiles; tile++)
     {
-        board->matrix[i] = malloc(size * sizeof(CaseType *));
-        if (board->matrix[i] == NULL) // if the allocation failed we free all the memory allocated before and exit the program
+        int slot = hashTile(board, board->tiles[tile].x, board->tiles[tile].y);
+        while (board->tileIndex[slot] != -1)
         {
-            printf("Error: allocation failed for matrix creation\n");
-            for (int j = 0; j < i; j++)
-            {
-                free(board->matrix[j]);
-            }
-            free(board->matrix);
-            free(board);
-            exit(1);
+            slot = (slot + 1) & (board->indexCapacity - 1);
         }
-        for (int j = 0; j < size; j++)
+        board->tileIndex[slot] = tile;
+    }
+    return STATUS_OK;
+}
+
+/*!
+ * \brief function to find a tile, creating it full of WATER if it is not stored
+ * \param board the board
+ * \param tileX the x position of the tile
+ * \param tileY the y position of the tile
+ * \return the position of the tile in board->tiles, -1 if the allocation failed
+ */
+static int findOrAddTile(Board *board, int tileX, int tileY)
+{
+    int tile = findTile(board, tileX, tileY);
+    if (tile != -1)
+    {
+        return tile;
+    }
+    // keep the index at most half full so the probes stay short
+    if (2 * (board->nbTiles + 1) > board->indexCapacity && growIndex(board) != STATUS_OK)
+    {
+        return -1;
+    }
+    if (board->nbTiles == board->tilesCapacity)
+    {
+        Tile *tiles = realloc(board->tiles, 2 * board->tilesCapacity * sizeof(Tile));
+        if (tiles == NULL)
         {
-            board->matrix[i][j] = WATER;
+            return -1;
         }
+        board->tiles = tiles;
+        board->tilesCapacity *= 2;
+    }
+    tile = board->nbTiles++;
+    board->tiles[tile].x = tileX;
+    board->tiles[tile].y = tileY;
+    memset(board->tiles[tile].rows, 0, sizeof(board->tiles[tile].rows));
+
+    int slot = hashTile(board, tileX, tileY);
+    while (board->tileIndex[slot] != -1)
+    {
+        slot = (slot + 1) & (board->indexCapacity - 1);
+    }
+    board->tileIndex[slot] = tile;
+    return tile;
+}
+
+/*!
+ * \brief function to give the type of a case
+ * \param board the board
+ * \param x the x position of the case
+ * \param y the y position of the case
+ * \return the type of the case, WATER when the case is outside the board
+ */
+CaseType getCase(const Board *board, int x, int y)
+{
+    if (board == NULL || x < 0 || x >= board->size || y < 0 || y >= board->size)
+    {
+        return WATER;
     }
-    return board;
+    int tile = findTile(board, x >> TILE_SHIFT, y >> TILE_SHIFT);
+    if (tile == -1)
+    {
+        return WATER;
+    }
+    uint32_t row = board->tiles[tile].rows[x & (TILE_SIZE - 1)];
+    return (CaseType)((row >> (2 * (y & (TILE_SIZE - 1)))) & 3);
+}
+
+/*!
+ * \brief function to change the type of a case
+ * \param board the board
+ * \param x the x position of the case
+ * \param y the y position of the case
+ * \param type the new type of the case
+ * \return STATUS_OK, STATUS_INVALID_ARGUMENT, STATUS_OUT_OF_BOARD or STATUS_NO_MEMORY
+ */
+Status setCase(Board *board, int x, int y, CaseType type)
+{
+    // check if the parameters are correct
+    if (board == NULL || type < WATER || type > WRECK)
+    {
+        return STATUS_INVALID_ARGUMENT;
+    }
+    if (x < 0 || x >= board->size || y < 0 || y >= board->size)
+    {
+        return STATUS_OUT_OF_BOARD;
+    }
+    // a case missing from the board is already WATER, no need for a tile
+    int tile = type == WATER ? findTile(board, x >> TILE_SHIFT, y >> TILE_SHIFT)
+                             : findOrAddTile(board, x >> TILE_SHIFT, y >> TILE_SHIFT);
+    if (tile == -1)
+    {
+        return type == WATER ? STATUS_OK : STATUS_NO_MEMORY;
+    }
+    uint32_t *row = &board->tiles[tile].rows[x & (TILE_SIZE - 1)];
+    int shift = 2 * (y & (TILE_SIZE - 1));
+    *row = (*row & ~(3u << shift)) | ((uint32_t)type << shift);
+    return STATUS_OK;
+}
+
+/*!
+ * \brief function to create the tile of a case
+ * \param board the board
+ * \param x the x position of the case
+ * \param y the y position of the case
+ * \return STATUS_OK, STATUS_INVALID_ARGUMENT, STATUS_OUT_OF_BOARD or STATUS_NO_MEMORY
+ */
+Status reserveCase(Board *board, int x, int y)
+{
+    // check if the parameters are correct
+    if (board == NULL)
+    {
+        return STATUS_INVALID_ARGUMENT;
+    }
+    if (x < 0 || x >= board->size || y < 0 || y >= board->size)
+    {
+        return STATUS_OUT_OF_BOARD;
+    }
+    return findOrAddTile(board, x >> TILE_SHIFT, y >> TILE_SHIFT) == -1 ? STATUS_NO_MEMORY : STATUS_OK;
+}
+
+/*!
+ * \brief function to free a board
+ * \param board the board, may be NULL
+ */
+void freeBoard(Board *board)
+{
+    if (board == NULL)
+    {
+        return;
+    }
+    free(board->tiles);
+    free(board->tileIndex);
+    free(board);
 }
 
 /*!
@@ -59,43 +328,38 @@ Board *createBoard(int size)
  * \param x the x position of the boat
  * \param y the y position of the boat
  * \param orientation the orientation of the boat
- * \return the boat
+ * \param boat the boat filled by the function
+ * \return STATUS_OK or STATUS_INVALID_ARGUMENT
  */
-Boat *createBoat(int size, int x, int y, Orientation orientation)
+Status createBoat(int size, int x, int y, Orientation orientation, Boat *boat)
 {
     // check if the size is correct
     if (size < 2 || size > 5)
     {
-        printf("Error: the size of the boat is not correct\n");
-        exit(1);
+        return STATUS_INVALID_ARGUMENT;
     }
     // check if the position is correct
     if (x < 0 || y < 0)
     {
-        printf("Error: the position of the boat is not correct\n");
-        exit(1);
+        return STATUS_INVALID_ARGUMENT;
     }
     // check if the orientation is correct
     if (orientation != HORIZONTAL && orientation != VERTICAL)
     {
-        printf("Error: the orientation of the boat is not correct\n");
-        exit(1);
+        return STATUS_INVALID_ARGUMENT;
     }
-    // allocation of the boat
-    Boat *boat = malloc(sizeof(Boat));
+    // check if the boat is correct
     if (boat == NULL)
     {
-        printf("Error: allocation failed for boat\n");
-        exit(1);
+        return STATUS_INVALID_ARGUMENT;
     }
 
     boat->size = size;
     boat->x = x;
     boat->y = y;
     boat->orientation = orientation;
-    boat->hits = 0;
 
-    return boat;
+    return STATUS_OK;
 }
 
 /*!
@@ -104,26 +368,23 @@ Boat *createBoat(int size, int x, int y, Orientation orientation)
  * \param boat the boat
  * \return 1 if the boat can be placed, 0 otherwise
  */
-int canPlaceBoat(Board *board, Boat *boat)
+int canPlaceBoat(const Board *board, const Boat *boat)
 {
-    // check if the board is correct
-    if (board == NULL)
+    // check if the board and the boat are correct
+    if (board == NULL || boat == NULL)
     {
-        printf("Error: the board is not correct\n");
-        exit(1);
+        return 0;
     }
-    // check if the boat is correct
-    if (boat == NULL)
+    // check if the boat is in the board
+    if (boat->x < 0 || boat->y < 0)
     {
-        printf("Error: the boat is not correct\n");
-        exit(1);
+        return 0;
     }
-    // check if the boat is in the board
-    if (boat->orientation == HORIZONTAL && boat->x + boat->size > board->size)
+    if (boat->orientation == HORIZONTAL && (boat->x + boat->size > board->size || boat->y >= board->size))
     {
         return 0;
     }
-    if (boat->orientation == VERTICAL && boat->y + boat->size > board->size)
+    if (boat->orientation == VERTICAL && (boat->y + boat->size > board->size || boat->x >= board->size))
     {
         return 0;
     }
@@ -134,7 +395,7 @@ int canPlaceBoat(Board *board, Boat *boat)
         int x = boat->x + (boat->orientation == HORIZONTAL ? i : 0);
         int y = boat->y + (boat->orientation == VERTICAL ? i : 0);
 
-        if (board->matrix[x][y] == BOAT)
+        if (getCase(board, x, y) == BOAT)
         {
             return 0;
         }
@@ -147,251 +408,282 @@ int canPlaceBoat(Board *board, Boat *boat)
  * \brief function to place a boat
  * \param board the board
  * \param boat the boat
+ * \return STATUS_OK, STATUS_INVALID_ARGUMENT, STATUS_CANT_PLACE or STATUS_NO_MEMORY
  */
-void placeBoat(Board *board, Boat *boat)
+Status placeBoat(Board *board, const Boat *boat)
 {
-    // check if the board is correct
-    if (board == NULL)
-    {
-        printf("Error: the board is not correct\n");
-        exit(1);
-    }
-    // check if the boat is correct
-    if (boat == NULL)
+    // check if the board and the boat are correct
+    if (board == NULL || boat == NULL)
     {
-        printf("Error: the boat is not correct\n");
-        exit(1);
+        return STATUS_INVALID_ARGUMENT;
     }
-    int retour = 0;
     // check if the boat can be placed
-    retour = canPlaceBoat(board, boat);
-    if (retour == 0)
+    if (!canPlaceBoat(board, boat))
     {
-        printf("Error: the boat can't be placed\n");
-        exit(1);
+        return STATUS_CANT_PLACE;
     }
 
+    // create the tiles first, so a failed allocation leaves no half boat
+    for (int i = 0; i < boat->size; i++)
+    {
+        int x = boat->x + (boat->orientation == HORIZONTAL ? i : 0);
+        int y = boat->y + (boat->orientation == VERTICAL ? i : 0);
+
+        if (findOrAddTile(board, x >> TILE_SHIFT, y >> TILE_SHIFT) == -1)
+        {
+            return STATUS_NO_MEMORY;
+        }
+    }
     // place the boat
     for (int i = 0; i < boat->size; i++)
     {
         int x = boat->x + (boat->orientation == HORIZONTAL ? i : 0);
         int y = boat->y + (boat->orientation == VERTICAL ? i : 0);
 
-        board->matrix[x][y] = BOAT;
+        setCase(board, x, y, BOAT);
+    }
+    return STATUS_OK;
+}
+
+/*!
+ * \brief function to add a boat to a fleet
+ * \param fleet the fleet
+ * \param boat the boat, copied into the fleet
+ * \param id the index of the boat in the fleet, may be NULL
+ * \return STATUS_OK, STATUS_INVALID_ARGUMENT or STATUS_FULL
+ */
+Status addBoatToFleet(Fleet *fleet, const Boat *boat, int *id)
+{
+    // check if the fleet and the boat are correct
+    if (fleet == NULL || boat == NULL)
+    {
+        return STATUS_INVALID_ARGUMENT;
+    }
+    // check if there is still room in the fleet
+    if (fleet->nbBoats >= NB_BOAT)
+    {
+        return STATUS_FULL;
+    }
+    int index = fleet->nbBoats;
+    fleet->size[index] = (uint8_t)boat->size;
+    fleet->x[index] = (uint32_t)boat->x;
+    fleet->y[index] = (uint32_t)boat->y;
+    fleet->orientation[index] = (uint8_t)boat->orientation;
+    fleet->hitMask[index] = 0;
+    fleet->nbBoats++;
+    if (id != NULL)
+    {
+        *id = index;
+    }
+    return STATUS_OK;
+}
+
+/*!
+ * \brief function to find the boat covering a case
+ * \param fleet the fleet
+ * \param x the x position of the case
+ * \param y the y position of the case
+ * \return the index of the boat, -1 if no boat covers the case
+ */
+int findBoat(const Fleet *fleet, int x, int y)
+{
+    // check if the fleet is correct
+    if (fleet == NULL)
+    {
+        return -1;
     }
+    for (int i = 0; i < fleet->nbBoats; i++)
+    {
+        // distance from the bow along the boat, and across it
+        int dx = x - (int)fleet->x[i];
+        int dy = y - (int)fleet->y[i];
+        int along = fleet->orientation[i] == HORIZONTAL ? dx : dy;
+        int across = fleet->orientation[i] == HORIZONTAL ? dy : dx;
+        if (across == 0 && along >= 0 && along < fleet->size[i])
+        {
+            return i;
+        }
+    }
+    return -1;
 }
 
 /*!
  * \brief function to initialize the boats
  * \param board the board
- * \param boats the array of boats
+ * \param fleet the fleet receiving the boats
  * \param nbBoats the number of boats
+ * \param rng the generator used to place the boats
+ * \return STATUS_OK, STATUS_INVALID_ARGUMENT or STATUS_NO_MEMORY
  */
-void initializeBoats(Board *board, Boat **boats, int nbBoats)
+Status initializeBoats(Board *board, Fleet *fleet, int nbBoats, Rng *rng)
 {
     // check all the parameters
-    //  check if the board is correct
-    if (board == NULL)
-    {
-        printf("Error: the board is not correct\n");
-        exit(1);
-    }
-    // check if the array of boats is correct
-    if (boats == NULL)
+    if (board == NULL || fleet == NULL || rng == NULL)
     {
-        printf("Error: the array of boats is not correct\n");
-        exit(1);
+        return STATUS_INVALID_ARGUMENT;
     }
     // check if the number of boats is correct
     if (nbBoats != NB_BOAT)
     {
-        printf("Error: the number of boats is not correct\n");
-        exit(1);
+        return STATUS_INVALID_ARGUMENT;
     }
 
     // Boat sizes for 5 boats
     int boatSizes[] = {5, 4, 3, 3, 2};
 
+    fleet->nbBoats = 0;
+    fleet->sunkMask = 0;
     // Initialize boats
     for (int i = 0; i < nbBoats; i++)
     {
-        Boat *boat;
+        Boat boat;
         do
         {
-            // Get boat size
-            int size = boatSizes[i];
             // Generate random position and orientation
-            int x = rand() % board->size;
-            int y = rand() % board->size;
-            Orientation orientation = rand() % 2 == 0 ? HORIZONTAL : VERTICAL;
-            // Create boat
-            boat = createBoat(size, x, y, orientation);
-        } while (!canPlaceBoat(board, boat));
-        // Place boat on the board
-        for (int j = 0; j < boat->size; j++)
+            boat.size = boatSizes[i];
+            boat.x = randomBelow(rng, board->size);
+            boat.y = randomBelow(rng, board->size);
+            boat.orientation = randomBelow(rng, 2) == 0 ? HORIZONTAL : VERTICAL;
+        } while (!canPlaceBoat(board, &boat));
+        // Place boat on the board and store it in the fleet
+        Status status = placeBoat(board, &boat);
+        if (status != STATUS_OK)
         {
-            int x = boat->x + (boat->orientation == HORIZONTAL ? j : 0);
-            int y = boat->y + (boat->orientation == VERTICAL ? j : 0);
-            board->matrix[x][y] = BOAT;
+            return status;
         }
-        // Store boat in array
-        boats[i] = boat;
+        addBoatToFleet(fleet, &boat, NULL);
     }
+    return STATUS_OK;
 }
 
 /*!
  * \brief function to create a game
  * \param size the size of the board
  * \param nbBoat the number of boats
- * \return the game
+ * \param seed the seed of the random generator of the game
+ * \param game the game created
+ * \return STATUS_OK, STATUS_INVALID_ARGUMENT or STATUS_NO_MEMORY
  */
-Game *createGame(int size, int nbBoat)
+Status createGame(int size, int nbBoat, uint64_t seed, Game **game)
 {
-    // check if the size is correct
-    if (size != SIZE)
+    // check if the parameters are correct
+    if (size < SIZE || size > MAX_SIZE || nbBoat != NB_BOAT || game == NULL)
     {
-        printf("Error: the size of the board is not correct\n");
-        exit(1);
-    }
-    // check if the number of boats is correct
-    if (nbBoat != NB_BOAT)
-    {
-        printf("Error: the number of boats is not correct\n");
-        exit(1);
+        return STATUS_INVALID_ARGUMENT;
     }
     // allocation of the game
-    Game *game = malloc(sizeof(Game));
-    if (game == NULL)
+    Game *created = malloc(sizeof(Game));
+    if (created == NULL)
     {
-        printf("Error: allocation failed for game\n");
-        exit(1);
+        return STATUS_NO_MEMORY;
     }
+    created->playerBoard = NULL;
+    created->computerBoard = NULL;
+    seedRandom(&created->rng, seed);
 
-    game->playerBoard = createBoard(size);
-    game->computerBoard = createBoard(size);
-
-    game->playerBoats = malloc(nbBoat * sizeof(Boat *));
-    if (game->playerBoats == NULL)
+    Status status = createBoard(size, &created->playerBoard);
+    if (status == STATUS_OK)
     {
-        printf("Error: allocation failed for playerBoats\n");
-        exit(1);
+        status = createBoard(size, &created->computerBoard);
     }
-
-    game->computerBoats = malloc(nbBoat * sizeof(Boat *));
-    if (game->computerBoats == NULL)
+    if (status != STATUS_OK)
     {
-        printf("Error: allocation failed for computerBoats\n");
-        exit(1);
+        freeGame(created);
+        return status;
     }
 
-    initializeBoats(game->playerBoard, game->playerBoats, nbBoat);
-    initializeBoats(game->computerBoard, game->computerBoats, nbBoat);
+    status = initializeBoats(created->playerBoard, &created->playerFleet, nbBoat, &created->rng);
+    if (status == STATUS_OK)
+    {
+        status = initializeBoats(created->computerBoard, &created->computerFleet, nbBoat, &created->rng);
+    }
+    if (status != STATUS_OK)
+    {
+        freeGame(created);
+        return status;
+    }
 
-    return game;
+    *game = created;
+    return STATUS_OK;
 }
 
 /*!
- * \brief function to clean the buffer
+ * \brief function to check if a boat is wrecked
+ * \param fleet the fleet
+ * \param id the index of the boat in the fleet
+ * \return 1 if the boat is wrecked, 0 otherwise
  */
-void cleanBuffer()
+int isBoatWrecked(const Fleet *fleet, int id)
 {
-    int c = 0;
-    while (c != '\n' && c != EOF)
+    // check if the boat is correct
+    if (fleet == NULL || id < 0 || id >= fleet->nbBoats)
     {
-        c = getchar();
+        return 0;
     }
+    // the boat is wrecked when every case of it is hit
+    return fleet->hitMask[id] == (1u << fleet->size[id]) - 1;
 }
 
 /*!
- * \brief function to display the board
- * \param board the board
- * \param isPlayer 1 if it's the player's board, 0 otherwise
+ * \brief function to check if all the boats of a fleet are wrecked
+ * \param fleet the fleet
+ * \return 1 if the fleet is wrecked, 0 otherwise
  */
-void displayBoard(Board *board, int isPlayer)
+int isFleetWrecked(const Fleet *fleet)
 {
-    // check if the board is correct
-    if (board == NULL)
-    {
-        printf("Error: the board is not correct\n");
-        exit(1);
-    }
-    // check if the isPlayer is correct
-    if (isPlayer != 0 && isPlayer != 1)
+    // check if the fleet is correct
+    if (fleet == NULL)
     {
-        printf("Error: the isPlayer is not correct\n");
-        exit(1);
+        return 0;
     }
+    return fleet->sunkMask == (1u << fleet->nbBoats) - 1;
+}
 
-    // display the board
-    if (isPlayer == 1)
-    {
-        printf("Ton plateau:\n");
-    }
-    else
-    {
-        printf("Plateau de l'ordinateur:\n");
-    }
-    // print column number
-    printf("  ");
-    for (int i = 0; i < board->size; i++)
+/*!
+ * \brief function to add a listener to the board
+ * \param board the board
+ * \param listener the function called on each shot event
+ * \param userData the pointer given back to the listener
+ * \return STATUS_OK, STATUS_INVALID_ARGUMENT or STATUS_FULL
+ */
+Status addShotListener(Board *board, ShotListener listener, void *userData)
+{
+    // check if the board and the listener are correct
+    if (board == NULL || listener == NULL)
     {
-        printf("%d ", i);
+        return STATUS_INVALID_ARGUMENT;
     }
-    printf("\n");
-    for (int i = 0; i < board->size; i++)
+    // check if there is still room for a listener
+    if (board->nbListeners >= MAX_LISTENERS)
     {
-        // print row number
-        printf("%d ", i);
-        for (int j = 0; j < board->size; j++)
-        {
-            // print the case
-            if (board->matrix[i][j] == WATER)
-            {
-                printf("~ ");
-            }
-            else if (board->matrix[i][j] == WATER_SHOT)
-            {
-                printf("o ");
-            }
-            else if (board->matrix[i][j] == BOAT)
-            {
-                if (isPlayer == 1)
-                {
-                    printf("B ");
-                }
-                else
-                {
-                    printf("~ ");
-                }
-            }
-            else if (board->matrix[i][j] == WRECK)
-            {
-                printf("X ");
-            }
-        }
-        printf("\n");
+        return STATUS_FULL;
     }
+    board->listeners[board->nbListeners] = listener;
+    board->listenersData[board->nbListeners] = userData;
+    board->nbListeners++;
+    return STATUS_OK;
 }
 
 /*!
- * \brief function to check if a boat is wrecked
- * \param boat the boat
- * \return 1 if the boat is wrecked, 0 otherwise
+ * \brief function to send an event to all the listeners of the board
+ * \param board the board
+ * \param type the type of the event
+ * \param x the x position of the shot
+ * \param y the y position of the shot
+ * \param boatId the index of the boat concerned, -1 if none
+ * \param outcome the last event of the shot, updated by the function, may be NULL
  */
-int isBoatWrecked(Boat *boat)
+static void emitShotEvent(Board *board, ShotEventType type, int x, int y, int boatId, ShotEvent *outcome)
 {
-    // check if the boat is correct
-    if (boat == NULL)
+    ShotEvent event = {type, x, y, boatId};
+    for (int i = 0; i < board->nbListeners; i++)
     {
-        printf("Error: the boat not correct\n");
-        exit(1);
+        board->listeners[i](&event, board->listenersData[i]);
     }
-    // check if the boat is wrecked
-    if (boat->hits == boat->size)
+    if (outcome != NULL)
     {
-        return 1;
+        *outcome = event;
     }
-    return 0;
 }
 
 /*!
@@ -399,148 +691,112 @@ int isBoatWrecked(Boat *boat)
  * \param board the board
  * \param x the x position of the shot
  * \param y the y position of the shot
- * \param boats the array of boats
+ * \param fleet the fleet placed on the board
+ * \param outcome the last event of the shot, may be NULL
+ * \return STATUS_OK, STATUS_INVALID_ARGUMENT, STATUS_OUT_OF_BOARD or STATUS_NO_MEMORY
  */
-void fireShot(Board *board, int x, int y, Boat **boats)
+Status fireShot(Board *board, int x, int y, Fleet *fleet, ShotEvent *outcome)
 {
-    // check if the board is correct
-    if (board == NULL)
+    // check if the board and the fleet are correct
+    if (board == NULL || fleet == NULL)
     {
-        printf("Error: the board is not correct\n");
-        exit(1);
+        return STATUS_INVALID_ARGUMENT;
     }
     // check if the position is correct
     if (x < 0 || x >= board->size || y < 0 || y >= board->size)
     {
-        printf("Error: the position is not correct\n");
-        exit(1);
-    }
-    // check if the array of boats is correct
-    if (boats == NULL)
-    {
-        printf("Error: the array of boats is not correct\n");
-        exit(1);
+        return STATUS_OUT_OF_BOARD;
     }
     // Check if the shot hit a boat
-    if (board->matrix[x][y] == BOAT)
+    CaseType target = getCase(board, x, y);
+    if (target == BOAT)
     {
         // Find the boat that was hit
-        Boat *hitBoat = NULL;
-        for (int i = 0; i < NB_BOAT; i++)
+        int hitBoat = findBoat(fleet, x, y);
+        if (hitBoat == -1)
         {
-            for (int j = 0; j < boats[i]->size; j++)
-            {
-                int boatX = boats[i]->x;
-                int boatY = boats[i]->y;
-                if (boats[i]->orientation == HORIZONTAL)
-                {
-                    boatX += j;
-                }
-                else if (boats[i]->orientation == VERTICAL)
-                {
-                    boatY += j;
-                }
-                if (boatX == x && boatY == y)
-                {
-                    hitBoat = boats[i];
-                    break;
-                }
-            }
-            if (hitBoat != NULL)
-            {
-                break;
-            }
+            // the fleet is not the one placed on this board
+            return STATUS_INVALID_ARGUMENT;
         }
-        // Mark the shot as a hit
-        board->matrix[x][y] = WRECK;
-        printf("Touché\n");
+        // Mark the shot as a hit, the case already has its tile
+        setCase(board, x, y, WRECK);
 
-        // Increment the hits counter
-        hitBoat->hits++;
+        // Mark the case of the boat as hit
+        int offset = (x - (int)fleet->x[hitBoat]) + (y - (int)fleet->y[hitBoat]);
+        fleet->hitMask[hitBoat] |= (uint8_t)(1u << offset);
+        emitShotEvent(board, SHOT_HIT, x, y, hitBoat, outcome);
 
         // Check if the boat is wrecked after marking the shot as a hit
-        if (isBoatWrecked(hitBoat))
+        if (isBoatWrecked(fleet, hitBoat))
         {
-            printf("Coulé\n");
+            fleet->sunkMask |= (uint8_t)(1u << hitBoat);
+            emitShotEvent(board, SHOT_SUNK, x, y, hitBoat, outcome);
+            // the fleet says it, whatever way its boats were added
+            if (isFleetWrecked(fleet))
+            {
+                emitShotEvent(board, SHOT_FLEET_DESTROYED, x, y, hitBoat, outcome);
+            }
         }
     }
-    else if (board->matrix[x][y] == WRECK || board->matrix[x][y] == WATER_SHOT)
+    else if (target == WRECK || target == WATER_SHOT)
     {
-        printf("Tu as déjà tiré ici\n");
+        emitShotEvent(board, SHOT_ALREADY_FIRED, x, y, -1, outcome);
     }
     else
     {
-        // The shot missed
-        board->matrix[x][y] = WATER_SHOT;
-        printf("A l'eau\n");
+        // The shot missed, the case may need a new tile
+        Status status = setCase(board, x, y, WATER_SHOT);
+        if (status != STATUS_OK)
+        {
+            return status;
+        }
+        emitShotEvent(board, SHOT_MISS, x, y, -1, outcome);
     }
+    return STATUS_OK;
 }
 
 /*!
  * \brief function to play a turn for the player
  * \param game the game
+ * \param x the x position of the shot
+ * \param y the y position of the shot
+ * \param outcome the last event of the shot, may be NULL
+ * \return STATUS_OK, STATUS_INVALID_ARGUMENT, STATUS_OUT_OF_BOARD or STATUS_NO_MEMORY
  */
-void playerTurn(Game *game)
+Status playerTurn(Game *game, int x, int y, ShotEvent *outcome)
 {
     // check if the game is correct
     if (game == NULL)
     {
-        printf("Error: the game is not correct\n");
-        exit(1);
-    }
-    // ask the player to enter a position
-    int x, y, retour = 0;
-    printf("Entrez la position x :");
-    while (retour != 1)
-    {
-        retour = scanf("%d", &x);
-        cleanBuffer();
-    }
-    retour = 0;
-    printf("Entrez la position y :");
-    while (retour != 1)
-    {
-        retour = scanf("%d", &y);
-        cleanBuffer();
-    }
-    printf("\n");
-    // check if the position is correct
-    if (x < 0 || x >= game->playerBoard->size || y < 0 || y >= game->playerBoard->size)
-    {
-        printf("la position est en dehors du plateau de jeu\n");
-        exit(1);
+        return STATUS_INVALID_ARGUMENT;
     }
     // fire at the position
-    fireShot(game->computerBoard, x, y, game->computerBoats);
-    // display the board
-    displayBoard(game->computerBoard, 0);
+    return fireShot(game->computerBoard, x, y, &game->computerFleet, outcome);
 }
 
 /*!
  * \brief function to play a turn for the computer
  * \param game the game
+ * \param outcome the last event of the shot, may be NULL
+ * \return STATUS_OK, STATUS_INVALID_ARGUMENT or STATUS_NO_MEMORY
  */
-void computerTurn(Game *game)
+Status computerTurn(Game *game, ShotEvent *outcome)
 {
-    // check if the game is correct
-    if (game == NULL)
+    // check if the game is correct and not over, otherwise there may be no case left to shoot
+    if (game == NULL || isGameOver(game))
     {
-        printf("Error: the game is not correct\n");
-        exit(1);
+        return STATUS_INVALID_ARGUMENT;
     }
     // Generate random coordinates for the shot
     int x, y;
     do
     {
-        x = rand() % game->playerBoard->size;
-        y = rand() % game->playerBoard->size;
-    } while (game->playerBoard->matrix[x][y] == WATER_SHOT || game->playerBoard->matrix[x][y] == WRECK);
+        x = randomBelow(&game->rng, game->playerBoard->size);
+        y = randomBelow(&game->rng, game->playerBoard->size);
+    } while (getCase(game->playerBoard, x, y) == WATER_SHOT || getCase(game->playerBoard, x, y) == WRECK);
 
     // Fire shot
-    fireShot(game->playerBoard, x, y, game->playerBoats);
-
-    // Display the board
-    displayBoard(game->playerBoard, 1);
+    return fireShot(game->playerBoard, x, y, &game->playerFleet, outcome);
 }
 
 /*!
@@ -548,22 +804,15 @@ void computerTurn(Game *game)
  * \param game the game
  * \return 1 if all player's boats are wrecked, 0 otherwise
  */
-int playerBoatsWrecked(Game *game)
+int playerBoatsWrecked(const Game *game)
 {
     // check if the game is correct
     if (game == NULL)
     {
-        printf("Error: the game is not correct\n");
-        exit(1);
-    }
-    for (int i = 0; i < NB_BOAT; i++)
-    {
-        if (!isBoatWrecked(game->playerBoats[i]))
-        {
-            return 0; // Un bateau du joueur n'est pas coulé
-        }
+        return 0;
     }
-    return 1; // Tous les bateaux du joueur sont coulés
+    // the sunk mask is kept up to date by fireShot
+    return isFleetWrecked(&game->playerFleet);
 }
 
 /*!
@@ -571,78 +820,29 @@ int playerBoatsWrecked(Game *game)
  * \param game the game
  * \return 1 if the game is over, 0 otherwise
  */
-int isGameOver(Game *game)
+int isGameOver(const Game *game)
 {
     // check if the game is correct
     if (game == NULL)
     {
-        printf("Error: the game is not correct\n");
-        exit(1);
-    }
-    int playerBoatsWrecked = 1;
-    int computerBoatsWrecked = 1;
-
-    // check if all player's boats are wrecked
-    for (int i = 0; i < NB_BOAT; i++)
-    {
-        if (isBoatWrecked(game->playerBoats[i]) == 0)
-        {
-            playerBoatsWrecked = 0;
-            break;
-        }
-    }
-
-    // check if all computer's boats are wrecked
-    for (int i = 0; i < NB_BOAT; i++)
-    {
-        if (isBoatWrecked(game->computerBoats[i]) == 0)
-        {
-            computerBoatsWrecked = 0;
-            break;
-        }
+        return 0;
     }
-
-    return playerBoatsWrecked || computerBoatsWrecked;
+    // the sunk masks are kept up to date by fireShot, no need to scan the boats
+    return isFleetWrecked(&game->playerFleet) || isFleetWrecked(&game->computerFleet);
 }
 
 /*!
  * \brief function to free the memory
- * \param game the game
+ * \param game the game, may be NULL
  */
 void freeGame(Game *game)
 {
-    // check if the game is correct
     if (game == NULL)
     {
-        printf("Error: the game is not correct\n");
-        exit(1);
+        return;
     }
     // free the memory
-    for (int i = 0; i < game->playerBoard->size; i++)
-    {
-        free(game->playerBoard->matrix[i]);
-    }
-    free(game->playerBoard->matrix);
-    free(game->playerBoard);
-
-    for (int i = 0; i < game->computerBoard->size; i++)
-    {
-        free(game->computerBoard->matrix[i]);
-    }
-    free(game->computerBoard->matrix);
-    free(game->computerBoard);
-
-    for (int i = 0; i < NB_BOAT; i++)
-    {
-        free(game->playerBoats[i]);
-    }
-    free(game->playerBoats);
-
-    for (int i = 0; i < NB_BOAT; i++)
-    {
-        free(game->computerBoats[i]);
-    }
-    free(game->computerBoats);
-
+    freeBoard(game->playerBoard);
+    freeBoard(game->computerBoard);
     free(game);
-}
\ No newline at end of file
+}
@@ -1,20 +1,41 @@
 /**
  * @file fonctions.h
  * @brief Header file containing function declarations for game logic.
+ *
+ * The game logic is built as a library (libbataille.a and libbataille.so).
+ * It has no global state and does no input/output: the functions report
+ * errors with a Status and the results of the shots with a ShotEvent, so many
+ * games can live in the same process.
  */
 
 #ifndef FONCTIONS_H
 #define FONCTIONS_H
 
-#include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
-#include <time.h>
-#include <unistd.h>
 #define SIZE 10   // size of the board
 #define NB_BOAT 5 // number of boats
+#define MAX_LISTENERS 4 // number of shot listeners a board can hold
+#define MAX_SIZE 1000000 // largest size of a board
+#define TILE_SHIFT 4 // a tile holds 2^TILE_SHIFT x 2^TILE_SHIFT cases
+#define TILE_SIZE (1 << TILE_SHIFT) // number of cases on a side of a tile
 
 // il y a ici toutes les header de fonctions et les structures qui sont utilisées dans le main pour la bataille navale
 
+/**
+ * @enum Status
+ * @brief Represents the result of a function of the library.
+ */
+typedef enum
+{
+    STATUS_OK,               /**< The function succeeded. */
+    STATUS_INVALID_ARGUMENT, /**< A parameter is NULL or has a wrong value. */
+    STATUS_OUT_OF_BOARD,     /**< The position is outside the board. */
+    STATUS_CANT_PLACE,       /**< The boat overlaps another boat or leaves the board. */
+    STATUS_FULL,             /**< There is no room left (boats of a fleet, listeners of a board). */
+    STATUS_NO_MEMORY         /**< An allocation failed. */
+} Status;
+
 /**
  * @enum CaseType
  * @brief Represents the type of a case.
@@ -37,6 +58,20 @@ typedef enum
     VERTICAL
 } Orientation;
 
+/**
+ * @struct Tile
+ * @brief Represents a square of TILE_SIZE x TILE_SIZE cases of a board.
+ *
+ * Each case takes 2 bits (its CaseType): bits 2y and 2y + 1 of rows[x] hold
+ * the case (x, y) of the tile. A tile full of WATER is all zeros.
+ */
+typedef struct
+{
+    int x;                    /**< X position of the tile, in tiles. */
+    int y;                    /**< Y position of the tile, in tiles. */
+    uint32_t rows[TILE_SIZE]; /**< Cases of the tile, one row per x. */
+} Tile;
+
 /**
  * @struct Boat
  * @brief Represents a boat.
@@ -47,19 +82,91 @@ typedef struct
     int x;                   /**< X position of the boat. */
     int y;                   /**< Y position of the boat. */
     Orientation orientation; /**< Orientation of the boat (HORIZONTAL or VERTICAL). */
-    int hits;                /**< Number of hits the boat has taken. */
 } Boat;
 
+/**
+ * @struct Fleet
+ * @brief Represents the boats of one side, stored field by field.
+ *
+ * Each array holds one field for every boat, so the whole fleet fits in one
+ * cache line (60 bytes), with positions on 32 bits for the boards of
+ * MAX_SIZE. The hits of a boat are kept as a bitmask (bit i set when case i
+ * of the boat is hit), so a boat is wrecked when its mask is full.
+ */
+typedef struct
+{
+    uint8_t size[NB_BOAT];        /**< Size of each boat. */
+    uint32_t x[NB_BOAT];          /**< X position of each boat. */
+    uint32_t y[NB_BOAT];          /**< Y position of each boat. */
+    uint8_t orientation[NB_BOAT]; /**< Orientation of each boat. */
+    uint8_t hitMask[NB_BOAT];     /**< Cases hit on each boat, one bit per case. */
+    uint8_t sunkMask;             /**< Wrecked boats, one bit per boat. */
+    uint8_t nbBoats;              /**< Number of boats in the fleet. */
+} Fleet;
+
+/**
+ * @enum ShotEventType
+ * @brief Represents what happened after a shot.
+ */
+typedef enum
+{
+    SHOT_MISS,            /**< The shot hit the water. */
+    SHOT_HIT,             /**< The shot hit a boat. */
+    SHOT_SUNK,            /**< The shot sank a boat. */
+    SHOT_FLEET_DESTROYED, /**< The shot sank the last boat of the fleet. */
+    SHOT_ALREADY_FIRED    /**< The case had already been shot. */
+} ShotEventType;
+
+/**
+ * @struct ShotEvent
+ * @brief Represents an event emitted by fireShot.
+ */
+typedef struct
+{
+    ShotEventType type; /**< Type of the event. */
+    int x;              /**< X position of the shot. */
+    int y;              /**< Y position of the shot. */
+    int boatId;         /**< Index of the boat concerned, -1 if none. */
+} ShotEvent;
+
+/**
+ * @brief Function called for every event emitted on a board.
+ * @param event The event.
+ * @param userData The pointer given when the listener was added.
+ */
+typedef void (*ShotListener)(const ShotEvent *event, void *userData);
+
 /**
  * @struct Board
  * @brief Represents the game board.
+ *
+ * Only the tiles holding a case other than WATER are stored, found through a
+ * hash index on their position, so the memory grows with the boats and the
+ * shots rather than with the size of the board. The cases are read and
+ * written with getCase and setCase.
  */
 typedef struct
 {
-    CaseType **matrix; /**< 2D matrix representing the board. */
-    int size;          /**< Size of the board. */
+    Tile *tiles;                           /**< Tiles stored, in the order they were created. */
+    int nbTiles;                           /**< Number of tiles stored. */
+    int tilesCapacity;                     /**< Number of tiles allocated. */
+    int *tileIndex;                        /**< Hash index: position of a tile in tiles, -1 if the slot is empty. */
+    int indexCapacity;                     /**< Number of slots of the index, a power of two. */
+    int size;                              /**< Size of the board. */
+    ShotListener listeners[MAX_LISTENERS]; /**< Functions called on each shot event. */
+    void *listenersData[MAX_LISTENERS];    /**< User data given to each listener. */
+    int nbListeners;                       /**< Number of listeners registered. */
 } Board;
 
+/**
+ * @struct Rng
+ * @brief Random number generator (splitmix64), owned by the one who draws from it.
+ */
+typedef struct
+{
+    uint64_t state; /**< Current state of the generator. */
+} Rng;
+
 /**
  * @struct Game
  * @brief Represents the game.
@@ -68,16 +175,90 @@ typedef struct
 {
     Board *playerBoard;   /**< The player's board. */
     Board *computerBoard; /**< The computer's board. */
-    Boat **playerBoats;   /**< The player's boats. */
-    Boat **computerBoats; /**< The computer's boats. */
+    Fleet playerFleet;    /**< The player's boats. */
+    Fleet computerFleet;  /**< The computer's boats. */
+    Rng rng;              /**< Random generator of the game. */
 } Game;
 
+/**
+ * @brief Gives a description of a status.
+ * @param status The status.
+ * @return A constant string describing the status.
+ */
+const char *statusMessage(Status status);
+
+/**
+ * @brief Seeds a random generator.
+ * @param rng The generator.
+ * @param seed The seed.
+ */
+void seedRandom(Rng *rng, uint64_t seed);
+
+/**
+ * @brief Draws a random 64 bits number.
+ * @param rng The generator.
+ * @return The number.
+ */
+uint64_t nextRandom(Rng *rng);
+
+/**
+ * @brief Draws a random number below a bound.
+ * @param rng The generator.
+ * @param bound The bound, greater than 0.
+ * @return A number between 0 and bound - 1.
+ */
+int randomBelow(Rng *rng, int bound);
+
 /**
  * @brief Creates a board.
- * @param size The size of the board.
- * @return A pointer to the board.
+ * @param size The size of the board, from 1 to MAX_SIZE.
+ * @param board The board created.
+ * @return STATUS_OK, STATUS_INVALID_ARGUMENT or STATUS_NO_MEMORY.
+ */
+Status createBoard(int size, Board **board);
+
+/**
+ * @brief Resets every case of a board to WATER, keeping the memory allocated.
+ * @param board The board.
  */
-Board *createBoard(int size);
+void clearBoard(Board *board);
+
+/**
+ * @brief Gives the type of a case.
+ * @param board The board.
+ * @param x The x position of the case.
+ * @param y The y position of the case.
+ * @return The type of the case, WATER when the case is outside the board.
+ */
+CaseType getCase(const Board *board, int x, int y);
+
+/**
+ * @brief Changes the type of a case.
+ * @param board The board.
+ * @param x The x position of the case.
+ * @param y The y position of the case.
+ * @param type The new type of the case.
+ * @return STATUS_OK, STATUS_INVALID_ARGUMENT, STATUS_OUT_OF_BOARD or STATUS_NO_MEMORY.
+ */
+Status setCase(Board *board, int x, int y, CaseType type);
+
+/**
+ * @brief Creates the tile of a case, so that writing the case never allocates.
+ *
+ * Once every case written by a set of threads is reserved, the threads may
+ * call setCase at the same time on cases of different rows (x).
+ * @param board The board.
+ * @param x The x position of the case.
+ * @param y The y position of the case.
+ * @return STATUS_OK, STATUS_INVALID_ARGUMENT, STATUS_OUT_OF_BOARD or STATUS_NO_MEMORY.
+ */
+Status reserveCase(Board *board, int x, int y);
+
+/**
+ * @brief Frees the memory allocated for a board.
+ * @param board The board, may be NULL.
+ */
+void freeBoard(Board *board);
 
 /**
  * @brief Creates a boat.
@@ -85,98 +266,136 @@ Board *createBoard(int size);
  * @param x The x position of the boat.
  * @param y The y position of the boat.
  * @param orientation The orientation of the boat.
- * @return A pointer to the boat.
+ * @param boat The boat filled by the function.
+ * @return STATUS_OK or STATUS_INVALID_ARGUMENT.
  */
-Boat *createBoat(int size, int x, int y, Orientation orientation);
+Status createBoat(int size, int x, int y, Orientation orientation, Boat *boat);
 
 /**
  * @brief Checks if a boat can be placed on the board.
  * @param board The board.
  * @param boat The boat.
- * @return 1 if the boat can be placed, 0 otherwise.
+ * @return 1 if the boat can be placed, 0 otherwise (also when a parameter is NULL).
  */
-int canPlaceBoat(Board *board, Boat *boat);
+int canPlaceBoat(const Board *board, const Boat *boat);
 
 /**
  * @brief Places a boat on the board.
  * @param board The board.
  * @param boat The boat.
+ * @return STATUS_OK, STATUS_INVALID_ARGUMENT, STATUS_CANT_PLACE or STATUS_NO_MEMORY.
  */
-void placeBoat(Board *board, Boat *boat);
+Status placeBoat(Board *board, const Boat *boat);
+
+/**
+ * @brief Adds a boat to a fleet.
+ * @param fleet The fleet.
+ * @param boat The boat, copied into the fleet.
+ * @param id The index of the boat in the fleet, may be NULL.
+ * @return STATUS_OK, STATUS_INVALID_ARGUMENT or STATUS_FULL.
+ */
+Status addBoatToFleet(Fleet *fleet, const Boat *boat, int *id);
+
+/**
+ * @brief Finds the boat covering a case.
+ * @param fleet The fleet.
+ * @param x The x position of the case.
+ * @param y The y position of the case.
+ * @return The index of the boat, -1 if no boat covers the case.
+ */
+int findBoat(const Fleet *fleet, int x, int y);
 
 /**
  * @brief Initializes the boats on the board.
  * @param board The board.
- * @param boats The boats.
+ * @param fleet The fleet receiving the boats.
  * @param nbBoats The number of boats.
+ * @param rng The generator used to place the boats.
+ * @return STATUS_OK, STATUS_INVALID_ARGUMENT or STATUS_NO_MEMORY.
  */
-void initializeBoats(Board *board, Boat **boats, int nbBoats);
+Status initializeBoats(Board *board, Fleet *fleet, int nbBoats, Rng *rng);
 
 /**
  * @brief Creates a game.
- * @param size The size of the board.
+ * @param size The size of the boards, from SIZE to MAX_SIZE.
  * @param nbBoat The number of boats.
- * @return A pointer to the game.
+ * @param seed The seed of the random generator of the game.
+ * @param game The game created.
+ * @return STATUS_OK, STATUS_INVALID_ARGUMENT or STATUS_NO_MEMORY.
  */
-Game *createGame(int size, int nbBoat);
+Status createGame(int size, int nbBoat, uint64_t seed, Game **game);
 
 /**
- * @brief Clears the buffer.
+ * @brief Checks if a boat is wrecked.
+ * @param fleet The fleet.
+ * @param id The index of the boat in the fleet.
+ * @return 1 if the boat is wrecked, 0 otherwise (also when the boat doesn't exist).
  */
-void cleanBuffer();
+int isBoatWrecked(const Fleet *fleet, int id);
 
 /**
- * @brief Displays the board.
- * @param board The board.
- * @param isPlayer 1 if the board is the player's, 0 otherwise.
+ * @brief Checks if all the boats of a fleet are wrecked.
+ * @param fleet The fleet.
+ * @return 1 if the fleet is wrecked, 0 otherwise (also when the fleet is NULL).
  */
-void displayBoard(Board *board, int isPlayer);
+int isFleetWrecked(const Fleet *fleet);
 
 /**
- * @brief Displays the board with the boats.
+ * @brief Adds a listener called for every shot event on the board.
  * @param board The board.
- * @param isPlayer 1 if the board is the player's, 0 otherwise.
+ * @param listener The function to call.
+ * @param userData Pointer given back to the listener.
+ * @return STATUS_OK, STATUS_INVALID_ARGUMENT or STATUS_FULL.
  */
-int isBoatWrecked(Boat *boat);
+Status addShotListener(Board *board, ShotListener listener, void *userData);
 
 /**
- * @brief Displays the board with the boats.
+ * @brief Fires a shot and emits the resulting events to the board's listeners.
  * @param board The board.
- * @param isPlayer 1 if the board is the player's, 0 otherwise.
+ * @param x The x position of the shot.
+ * @param y The y position of the shot.
+ * @param fleet The fleet placed on the board.
+ * @param outcome The last event emitted by the shot, may be NULL.
+ * @return STATUS_OK, STATUS_INVALID_ARGUMENT, STATUS_OUT_OF_BOARD or STATUS_NO_MEMORY.
  */
-void fireShot(Board *board, int x, int y, Boat **boats);
+Status fireShot(Board *board, int x, int y, Fleet *fleet, ShotEvent *outcome);
 
 /**
- * @brief Displays the board with the boats.
- * @param board The board.
- * @param isPlayer 1 if the board is the player's, 0 otherwise.
+ * @brief Plays the turn of the player: fires at the computer's board.
+ * @param game The game.
+ * @param x The x position of the shot.
+ * @param y The y position of the shot.
+ * @param outcome The last event emitted by the shot, may be NULL.
+ * @return STATUS_OK, STATUS_INVALID_ARGUMENT, STATUS_OUT_OF_BOARD or STATUS_NO_MEMORY.
  */
-void playerTurn(Game *game);
+Status playerTurn(Game *game, int x, int y, ShotEvent *outcome);
 
 /**
- * @brief Displays the board with the boats.
- * @param board The board.
- * @param isPlayer 1 if the board is the player's, 0 otherwise.
+ * @brief Plays the turn of the computer: fires at a random case of the player's board not shot yet.
+ * @param game The game.
+ * @param outcome The last event emitted by the shot, may be NULL.
+ * @return STATUS_OK, STATUS_INVALID_ARGUMENT or STATUS_NO_MEMORY.
  */
-void computerTurn(Game *game);
+Status computerTurn(Game *game, ShotEvent *outcome);
 
 /**
  * @brief Checks if the game is over.
  * @param game The game.
- * @return 1 if the game is over, 0 otherwise.
+ * @return 1 if the game is over, 0 otherwise (also when the game is NULL).
  */
-int isGameOver(Game *game);
+int isGameOver(const Game *game);
 
 /**
- * @brief Frees the memory allocated for the board.
- * @param board The board.
+ * @brief Frees the memory allocated for the game.
+ * @param game The game, may be NULL.
  */
 void freeGame(Game *game);
 
 /**
- * @brief Frees the memory allocated for the board.
- * @param board The board.
+ * @brief Checks if all the player's boats are wrecked.
+ * @param game The game.
+ * @return 1 if the player's boats are wrecked, 0 otherwise (also when the game is NULL).
  */
-int playerBoatsWrecked(Game *game);
+int playerBoatsWrecked(const Game *game);
 
 #endif // FONCTIONS_H
@@ -0,0 +1,832 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "historique.h"
+
+#define LOG_MAGIC 0x31474F4C54534948ULL   // "HISTLOG1"
+#define INDEX_MAGIC 0x31584449544E4948ULL // "HISTIDX1"
+#define DATES_MAGIC 0x3153455441445349ULL // "ISDATES1"
+#define FIRST_CAPACITY 4096               // number of matches of a new log
+#define FIRST_SLOTS 1024                  // number of entries of a new hash table
+
+/**
+ * @struct LogHeader
+ * @brief Header at the start of the log file, followed by the matches.
+ */
+typedef struct
+{
+    uint64_t magic;        /**< LOG_MAGIC. */
+    uint64_t nbMatches;    /**< Number of matches recorded. */
+    uint64_t capacity;     /**< Number of matches the file can hold. */
+    int64_t lastTimestamp; /**< Timestamp of the last match recorded, older ones may follow. */
+    uint64_t padding[4];   /**< Unused, keeps the matches aligned on 64 bytes. */
+} LogHeader;
+
+/**
+ * @struct IndexHeader
+ * @brief Header at the start of the index file, followed by the hash table of the players.
+ */
+typedef struct
+{
+    uint64_t magic;                         /**< INDEX_MAGIC. */
+    uint64_t indexedMatches;                /**< Number of matches of the log taken into account. */
+    uint64_t nbSlots;                       /**< Size of the hash table, a power of 2. */
+    uint64_t nbPlayers;                     /**< Number of used entries of the hash table. */
+    uint32_t leaderboard[LEADERBOARD_SIZE]; /**< Ids of the best players, the best first. */
+    uint32_t nbLeaders;                     /**< Number of players in the leaderboard. */
+    uint32_t dirty;                         /**< 1 while a match is being indexed, the index is rebuilt if it stays set. */
+    uint32_t padding[6];                    /**< Unused, keeps the table aligned on 64 bytes. */
+} IndexHeader;
+
+/**
+ * @struct DatesHeader
+ * @brief Header at the start of the dates file, followed by the indexes of the
+ *        matches sorted by timestamp, then by order of recording.
+ */
+typedef struct
+{
+    uint64_t magic;      /**< DATES_MAGIC. */
+    uint64_t nbDates;    /**< Number of matches sorted, the same as indexedMatches. */
+    uint64_t capacity;   /**< Number of matches the file can hold. */
+    uint64_t padding[5]; /**< Unused, keeps the indexes aligned on 64 bytes. */
+} DatesHeader;
+
+struct History
+{
+    int logFd;           /**< File descriptor of the log. */
+    LogHeader *log;      /**< Mapping of the log. */
+    size_t logBytes;     /**< Size of the mapping of the log. */
+    int indexFd;         /**< File descriptor of the index. */
+    IndexHeader *index;  /**< Mapping of the index. */
+    size_t indexBytes;   /**< Size of the mapping of the index. */
+    int datesFd;         /**< File descriptor of the index by date. */
+    DatesHeader *dates;  /**< Mapping of the index by date. */
+    size_t datesBytes;   /**< Size of the mapping of the index by date. */
+};
+
+/*!
+ * \brief function to give the matches of the log
+ * \param history the store
+ * \return the first match of the log
+ */
+static MatchRecord *matchesOf(History *history)
+{
+    return (MatchRecord *)(history->log + 1);
+}
+
+/*!
+ * \brief function to give the hash table of the index
+ * \param history the store
+ * \return the first entry of the hash table
+ */
+static PlayerStats *playersOf(History *history)
+{
+    return (PlayerStats *)(history->index + 1);
+}
+
+/*!
+ * \brief function to give the matches sorted by date
+ * \param history the store
+ * \return the index of the first match by date
+ */
+static uint64_t *datesOf(History *history)
+{
+    return (uint64_t *)(history->dates + 1);
+}
+
+/*!
+ * \brief function to map a file, growing it if needed
+ * \param fd the file descriptor
+ * \param bytes the size of the mapping
+ * \return the mapping, NULL on failure
+ */
+static void *mapFile(int fd, size_t bytes)
+{
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        return NULL;
+    }
+    if ((size_t)info.st_size < bytes && ftruncate(fd, (off_t)bytes) != 0)
+    {
+        return NULL;
+    }
+    void *mapping = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    return mapping == MAP_FAILED ? NULL : mapping;
+}
+
+/*!
+ * \brief function to give the size of a file
+ * \param fd the file descriptor
+ * \return the size of the file, 0 on failure
+ */
+static size_t fileSize(int fd)
+{
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        return 0;
+    }
+    return (size_t)info.st_size;
+}
+
+/*!
+ * \brief function to double the capacity of the log
+ * \param history the store
+ * \return 1 on success, 0 otherwise
+ */
+static int growLog(History *history)
+{
+    uint64_t capacity = history->log->capacity * 2;
+    size_t bytes = sizeof(LogHeader) + capacity * sizeof(MatchRecord);
+    // the old mapping is kept until the new one is there
+    LogHeader *log = mapFile(history->logFd, bytes);
+    if (log == NULL)
+    {
+        return 0;
+    }
+    munmap(history->log, history->logBytes);
+    history->log = log;
+    history->logBytes = bytes;
+    history->log->capacity = capacity;
+    return 1;
+}
+
+/*!
+ * \brief function to find the entry of a player in the hash table
+ * \param history the store
+ * \param playerId the id of the player
+ * \return the entry of the player, or the empty entry where it would go
+ */
+static PlayerStats *findSlot(History *history, uint32_t playerId)
+{
+    PlayerStats *players = playersOf(history);
+    uint64_t mask = history->index->nbSlots - 1;
+    uint64_t slot = (playerId * 2654435761u) & mask;
+    while (players[slot].used && players[slot].playerId != playerId)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return &players[slot];
+}
+
+/*!
+ * \brief function to empty the index and give it a hash table of a given size
+ * \param history the store
+ * \param nbSlots the size of the hash table, a power of 2
+ * \return 1 on success, 0 otherwise
+ */
+static int resetIndex(History *history, uint64_t nbSlots)
+{
+    size_t bytes = sizeof(IndexHeader) + nbSlots * sizeof(PlayerStats);
+    if (history->index != NULL)
+    {
+        munmap(history->index, history->indexBytes);
+    }
+    if (ftruncate(history->indexFd, 0) != 0)
+    {
+        history->index = NULL;
+        return 0;
+    }
+    history->index = mapFile(history->indexFd, bytes);
+    if (history->index == NULL)
+    {
+        return 0;
+    }
+    history->indexBytes = bytes;
+    history->index->magic = INDEX_MAGIC;
+    history->index->nbSlots = nbSlots;
+    // empty until the log is replayed: a crash before the end rebuilds it again
+    history->index->dirty = 1;
+    return 1;
+}
+
+/*!
+ * \brief function to empty the index by date
+ * \param history the store
+ * \param capacity the number of matches the file can hold
+ * \return 1 on success, 0 otherwise
+ */
+static int resetDates(History *history, uint64_t capacity)
+{
+    size_t bytes = sizeof(DatesHeader) + capacity * sizeof(uint64_t);
+    if (history->dates != NULL)
+    {
+        munmap(history->dates, history->datesBytes);
+    }
+    if (ftruncate(history->datesFd, 0) != 0)
+    {
+        history->dates = NULL;
+        return 0;
+    }
+    history->dates = mapFile(history->datesFd, bytes);
+    if (history->dates == NULL)
+    {
+        return 0;
+    }
+    history->datesBytes = bytes;
+    history->dates->magic = DATES_MAGIC;
+    history->dates->capacity = capacity;
+    return 1;
+}
+
+/*!
+ * \brief function to add a match to the index by date
+ * \param history the store
+ * \param matchIndex the index of the match
+ * \return 1 on success, 0 otherwise
+ */
+static int insertDate(History *history, uint64_t matchIndex)
+{
+    DatesHeader *dates = history->dates;
+    if (dates->nbDates == dates->capacity)
+    {
+        uint64_t capacity = dates->capacity * 2;
+        size_t bytes = sizeof(DatesHeader) + capacity * sizeof(uint64_t);
+        // the old mapping is kept until the new one is there
+        dates = mapFile(history->datesFd, bytes);
+        if (dates == NULL)
+        {
+            return 0;
+        }
+        munmap(history->dates, history->datesBytes);
+        history->dates = dates;
+        history->datesBytes = bytes;
+        dates->capacity = capacity;
+    }
+    // after the matches of the same date or older: almost always at the end,
+    // further back only when the clock went backwards
+    const MatchRecord *matches = matchesOf(history);
+    int64_t timestamp = matches[matchIndex].timestamp;
+    uint64_t *sorted = datesOf(history);
+    uint64_t low = 0;
+    uint64_t high = dates->nbDates;
+    while (low < high)
+    {
+        uint64_t middle = low + (high - low) / 2;
+        if (matches[sorted[middle]].timestamp <= timestamp)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    memmove(sorted + low + 1, sorted + low, (dates->nbDates - low) * sizeof(uint64_t));
+    sorted[low] = matchIndex;
+    dates->nbDates++;
+    return 1;
+}
+
+/*!
+ * \brief function to check the header and the hash table of the index
+ * \param history the store
+ * \return 1 if the index can be used, 0 if it has to be rebuilt
+ */
+static int isIndexValid(History *history)
+{
+    const IndexHeader *index = history->index;
+    if (index == NULL || index->magic != INDEX_MAGIC || index->dirty ||
+        index->indexedMatches > history->log->nbMatches || index->nbLeaders > LEADERBOARD_SIZE)
+    {
+        return 0;
+    }
+    // a power of 2 fitting in the file, the table being at most half full
+    uint64_t nbSlots = index->nbSlots;
+    if (nbSlots == 0 || (nbSlots & (nbSlots - 1)) != 0 ||
+        nbSlots > (history->indexBytes - sizeof(IndexHeader)) / sizeof(PlayerStats) || index->nbPlayers * 2 > nbSlots)
+    {
+        return 0;
+    }
+    // findSlot stops at the first empty entry: there must be some; and each
+    // match indexed counts once for its player
+    uint64_t used = 0;
+    uint64_t games = 0;
+    const PlayerStats *players = playersOf(history);
+    for (uint64_t i = 0; i < nbSlots; i++)
+    {
+        if (players[i].used)
+        {
+            used++;
+            games += players[i].games;
+        }
+    }
+    if (used != index->nbPlayers || games != index->indexedMatches)
+    {
+        return 0;
+    }
+    // the index by date holds every match indexed, each inside the log
+    const DatesHeader *dates = history->dates;
+    if (dates == NULL || dates->magic != DATES_MAGIC || dates->capacity == 0 ||
+        dates->capacity > (history->datesBytes - sizeof(DatesHeader)) / sizeof(uint64_t) ||
+        dates->nbDates != index->indexedMatches || dates->nbDates > dates->capacity)
+    {
+        return 0;
+    }
+    const uint64_t *sorted = datesOf(history);
+    for (uint64_t i = 0; i < dates->nbDates; i++)
+    {
+        if (sorted[i] >= history->log->nbMatches)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*!
+ * \brief function to double the size of the hash table
+ * \param history the store
+ * \return 1 on success, 0 otherwise
+ */
+static int growIndex(History *history)
+{
+    IndexHeader header = *history->index;
+    uint64_t nbSlots = header.nbSlots;
+    PlayerStats *old = malloc(nbSlots * sizeof(PlayerStats));
+    if (old == NULL)
+    {
+        return 0;
+    }
+    memcpy(old, playersOf(history), nbSlots * sizeof(PlayerStats));
+
+    if (!resetIndex(history, nbSlots * 2))
+    {
+        free(old);
+        return 0;
+    }
+    // the leaderboard holds ids, so it doesn't move with the entries
+    memcpy(history->index->leaderboard, header.leaderboard, sizeof(header.leaderboard));
+    history->index->nbLeaders = header.nbLeaders;
+    history->index->nbPlayers = header.nbPlayers;
+    history->index->indexedMatches = header.indexedMatches;
+    for (uint64_t i = 0; i < nbSlots; i++)
+    {
+        if (old[i].used)
+        {
+            *findSlot(history, old[i].playerId) = old[i];
+        }
+    }
+    free(old);
+    return 1;
+}
+
+/*!
+ * \brief function to compare two players for the leaderboard
+ * \param a the first player
+ * \param b the second player
+ * \return 1 if a is ranked before b, 0 otherwise
+ */
+static int isRankedBefore(const PlayerStats *a, const PlayerStats *b)
+{
+    // a player who never won needs "infinitely" many shots
+    uint32_t shotsA = a->bestShots == 0 ? UINT32_MAX : a->bestShots;
+    uint32_t shotsB = b->bestShots == 0 ? UINT32_MAX : b->bestShots;
+    if (a->wins != b->wins)
+    {
+        return a->wins > b->wins;
+    }
+    if (shotsA != shotsB)
+    {
+        return shotsA < shotsB;
+    }
+    return a->playerId < b->playerId;
+}
+
+/*!
+ * \brief function to move a player up the leaderboard after a match
+ * \param history the store
+ * \param player the player
+ */
+static void updateLeaderboard(History *history, PlayerStats *player)
+{
+    // the rank of a player only goes up, so only this player has to move
+    IndexHeader *index = history->index;
+    int position = -1;
+    for (uint32_t i = 0; i < index->nbLeaders; i++)
+    {
+        if (index->leaderboard[i] == player->playerId)
+        {
+            position = (int)i;
+            break;
+        }
+    }
+    if (position == -1)
+    {
+        if (index->nbLeaders < LEADERBOARD_SIZE)
+        {
+            position = (int)index->nbLeaders++;
+        }
+        else if (isRankedBefore(player, findSlot(history, index->leaderboard[LEADERBOARD_SIZE - 1])))
+        {
+            position = LEADERBOARD_SIZE - 1;
+        }
+        else
+        {
+            return;
+        }
+        index->leaderboard[position] = player->playerId;
+    }
+    while (position > 0 && isRankedBefore(player, findSlot(history, index->leaderboard[position - 1])))
+    {
+        index->leaderboard[position] = index->leaderboard[position - 1];
+        index->leaderboard[position - 1] = player->playerId;
+        position--;
+    }
+}
+
+/*!
+ * \brief function to take a match of the log into account in the index
+ * \param history the store
+ * \param matchIndex the index of the match
+ * \return 1 on success, 0 otherwise
+ */
+static int indexMatch(History *history, uint64_t matchIndex)
+{
+    MatchRecord *match = &matchesOf(history)[matchIndex];
+    // set before the first change: a crash halfway leaves it set and the
+    // index is rebuilt, instead of counting the match twice on the replay
+    __atomic_store_n(&history->index->dirty, 1, __ATOMIC_SEQ_CST);
+    // keep the hash table at most half full
+    if ((history->index->nbPlayers + 1) * 2 > history->index->nbSlots && !growIndex(history))
+    {
+        return 0;
+    }
+    PlayerStats *player = findSlot(history, match->playerId);
+    if (!player->used)
+    {
+        memset(player, 0, sizeof(PlayerStats));
+        player->playerId = match->playerId;
+        player->used = 1;
+        history->index->nbPlayers++;
+    }
+    match->previous = player->lastMatch;
+    player->lastMatch = matchIndex + 1;
+    player->games++;
+    player->totalShots += match->shots;
+    if (match->won)
+    {
+        player->wins++;
+        if (player->bestShots == 0 || match->shots < player->bestShots)
+        {
+            player->bestShots = match->shots;
+        }
+    }
+    updateLeaderboard(history, player);
+    if (!insertDate(history, matchIndex))
+    {
+        return 0;
+    }
+    history->index->indexedMatches = matchIndex + 1;
+    __atomic_store_n(&history->index->dirty, 0, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/*!
+ * \brief function to open a file of the store
+ * \param path the path of the store
+ * \param extension the extension of the file
+ * \return the file descriptor, -1 on failure
+ */
+static int openStoreFile(const char *path, const char *extension)
+{
+    size_t length = strlen(path) + strlen(extension) + 1;
+    char *name = malloc(length);
+    if (name == NULL)
+    {
+        return -1;
+    }
+    snprintf(name, length, "%s%s", path, extension);
+    int fd = open(name, O_RDWR | O_CREAT, 0644);
+    free(name);
+    return fd;
+}
+
+/*!
+ * \brief function to open a store
+ * \param path the path of the store, without extension
+ * \return the store, NULL on failure
+ */
+History *openHistory(const char *path)
+{
+    // check if the path is correct
+    if (path == NULL)
+    {
+        return NULL;
+    }
+    History *history = calloc(1, sizeof(History));
+    if (history == NULL)
+    {
+        return NULL;
+    }
+    history->logFd = openStoreFile(path, ".log");
+    history->indexFd = openStoreFile(path, ".idx");
+    history->datesFd = openStoreFile(path, ".dat");
+    if (history->logFd == -1 || history->indexFd == -1 || history->datesFd == -1)
+    {
+        closeHistory(history);
+        return NULL;
+    }
+    // one process at a time: the lock is held until the store is closed, so
+    // two games ending together record their matches one after the other
+    if (flock(history->logFd, LOCK_EX) != 0)
+    {
+        closeHistory(history);
+        return NULL;
+    }
+
+    // map the log, creating it if the file is empty
+    size_t logSize = fileSize(history->logFd);
+    int newLog = logSize == 0;
+    history->logBytes = newLog ? sizeof(LogHeader) + FIRST_CAPACITY * sizeof(MatchRecord) : logSize;
+    if (history->logBytes < sizeof(LogHeader))
+    {
+        closeHistory(history);
+        return NULL;
+    }
+    history->log = mapFile(history->logFd, history->logBytes);
+    if (history->log == NULL)
+    {
+        closeHistory(history);
+        return NULL;
+    }
+    if (newLog)
+    {
+        history->log->magic = LOG_MAGIC;
+        history->log->capacity = FIRST_CAPACITY;
+    }
+    if (history->log->magic != LOG_MAGIC ||
+        history->log->capacity > (history->logBytes - sizeof(LogHeader)) / sizeof(MatchRecord) ||
+        history->log->nbMatches > history->log->capacity)
+    {
+        closeHistory(history);
+        return NULL;
+    }
+
+    // map the indexes, rebuilding them from the log if one is missing or corrupted
+    size_t indexSize = fileSize(history->indexFd);
+    if (indexSize >= sizeof(IndexHeader))
+    {
+        history->index = mapFile(history->indexFd, indexSize);
+        history->indexBytes = indexSize;
+    }
+    size_t datesSize = fileSize(history->datesFd);
+    if (datesSize >= sizeof(DatesHeader))
+    {
+        history->dates = mapFile(history->datesFd, datesSize);
+        history->datesBytes = datesSize;
+    }
+    if (!isIndexValid(history))
+    {
+        if (!resetIndex(history, FIRST_SLOTS) || !resetDates(history, FIRST_CAPACITY))
+        {
+            closeHistory(history);
+            return NULL;
+        }
+    }
+    // take into account the matches written after the last update of the index
+    for (uint64_t i = history->index->indexedMatches; i < history->log->nbMatches; i++)
+    {
+        if (!indexMatch(history, i))
+        {
+            closeHistory(history);
+            return NULL;
+        }
+    }
+    history->index->dirty = 0;
+    return history;
+}
+
+/*!
+ * \brief function to append a match to the store
+ * \param history the store
+ * \param match the match
+ * \return 1 if the match was recorded, 0 otherwise
+ */
+int recordMatch(History *history, const MatchRecord *match)
+{
+    // check if the parameters are correct
+    if (history == NULL || match == NULL)
+    {
+        return 0;
+    }
+    if (history->log->nbMatches == history->log->capacity && !growLog(history))
+    {
+        return 0;
+    }
+    uint64_t matchIndex = history->log->nbMatches;
+    MatchRecord *stored = &matchesOf(history)[matchIndex];
+    // the real date is kept, even older than the last match: the index by
+    // date keeps the order
+    *stored = *match;
+    stored->previous = 0;
+    // the match only counts once it is fully written
+    history->log->lastTimestamp = stored->timestamp;
+    history->log->nbMatches = matchIndex + 1;
+    return indexMatch(history, matchIndex);
+}
+
+/*!
+ * \brief function to give the number of matches
+ * \param history the store
+ * \return the number of matches
+ */
+uint64_t countMatches(History *history)
+{
+    // check if the history is correct
+    if (history == NULL)
+    {
+        return 0;
+    }
+    return history->log->nbMatches;
+}
+
+/*!
+ * \brief function to give a match of the log
+ * \param history the store
+ * \param index the index of the match
+ * \return the match, NULL if the index is out of the log
+ */
+const MatchRecord *getMatch(History *history, uint64_t index)
+{
+    if (index >= countMatches(history))
+    {
+        return NULL;
+    }
+    return &matchesOf(history)[index];
+}
+
+/*!
+ * \brief function to give a match in order of date
+ * \param history the store
+ * \param rank the rank of the match by date
+ * \return the match, NULL if the rank is out of the log
+ */
+const MatchRecord *getMatchByDate(History *history, uint64_t rank)
+{
+    if (rank >= countMatches(history))
+    {
+        return NULL;
+    }
+    return &matchesOf(history)[datesOf(history)[rank]];
+}
+
+/*!
+ * \brief function to find the first match at or after a date
+ * \param history the store
+ * \param timestamp the date
+ * \return the rank of the match by date, countMatches if there is none
+ */
+uint64_t findMatchByDate(History *history, int64_t timestamp)
+{
+    // binary search in the index by date
+    uint64_t low = 0;
+    uint64_t high = countMatches(history);
+    if (high == 0)
+    {
+        return 0;
+    }
+    const MatchRecord *matches = matchesOf(history);
+    const uint64_t *sorted = datesOf(history);
+    while (low < high)
+    {
+        uint64_t middle = low + (high - low) / 2;
+        if (matches[sorted[middle]].timestamp < timestamp)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/*!
+ * \brief function to give the statistics of a player
+ * \param history the store
+ * \param playerId the id of the player
+ * \param stats the statistics, filled by the function
+ * \return 1 if the player has played, 0 otherwise
+ */
+int getPlayerStats(History *history, uint32_t playerId, PlayerStats *stats)
+{
+    // check if the parameters are correct
+    if (history == NULL || stats == NULL)
+    {
+        return 0;
+    }
+    PlayerStats *player = findSlot(history, playerId);
+    if (!player->used)
+    {
+        return 0;
+    }
+    *stats = *player;
+    return 1;
+}
+
+/*!
+ * \brief function to give the last matches of a player
+ * \param history the store
+ * \param playerId the id of the player
+ * \param matches the array filled with the matches, the newest first
+ * \param max the size of the array
+ * \return the number of matches written
+ */
+int getPlayerHistory(History *history, uint32_t playerId, MatchRecord *matches, int max)
+{
+    PlayerStats player;
+    // check if the parameters are correct
+    if (matches == NULL || max < 0)
+    {
+        return 0;
+    }
+    if (!getPlayerStats(history, playerId, &player))
+    {
+        return 0;
+    }
+    int count = 0;
+    uint64_t next = player.lastMatch;
+    // each match points to an older one, a broken link ends the walk
+    uint64_t limit = countMatches(history) + 1;
+    while (next != 0 && next < limit && count < max)
+    {
+        matches[count] = matchesOf(history)[next - 1];
+        limit = next;
+        next = matches[count].previous;
+        count++;
+    }
+    return count;
+}
+
+/*!
+ * \brief function to give the best players
+ * \param history the store
+ * \param players the array filled with the players
+ * \param max the size of the array
+ * \return the number of players written
+ */
+int getLeaderboard(History *history, PlayerStats *players, int max)
+{
+    // check if the parameters are correct
+    if (history == NULL || players == NULL || max < 0)
+    {
+        return 0;
+    }
+    int count = 0;
+    while (count < max && (uint32_t)count < history->index->nbLeaders)
+    {
+        players[count] = *findSlot(history, history->index->leaderboard[count]);
+        count++;
+    }
+    return count;
+}
+
+/*!
+ * \brief function to close a store
+ * \param history the store
+ */
+void closeHistory(History *history)
+{
+    if (history == NULL)
+    {
+        return;
+    }
+    if (history->log != NULL)
+    {
+        msync(history->log, history->logBytes, MS_SYNC);
+        munmap(history->log, history->logBytes);
+    }
+    if (history->index != NULL)
+    {
+        msync(history->index, history->indexBytes, MS_SYNC);
+        munmap(history->index, history->indexBytes);
+    }
+    if (history->dates != NULL)
+    {
+        msync(history->dates, history->datesBytes, MS_SYNC);
+        munmap(history->dates, history->datesBytes);
+    }
+    if (history->logFd > 0)
+    {
+        close(history->logFd);
+    }
+    if (history->indexFd > 0)
+    {
+        close(history->indexFd);
+    }
+    if (history->datesFd > 0)
+    {
+        close(history->datesFd);
+    }
+    free(history);
+}
@@ -0,0 +1,145 @@
+/**
+ * @file historique.h
+ * @brief Header file of the persistent store of the match results.
+ *
+ * The matches are appended to a memory-mapped log (<path>.log) and indexed in
+ * a second memory-mapped file (<path>.idx) holding a hash table of the players
+ * and the leaderboard. Each player entry points to its last match and each
+ * match to the previous match of the same player, so the history of a player
+ * is a walk through its own matches. A third file (<path>.dat) holds the
+ * indexes of the matches sorted by date: the log keeps the real dates, which
+ * go backwards when the clock does.
+ * The index can always be rebuilt from the log: it is brought up to date when
+ * the store is opened, and rebuilt when its header is corrupted or a crash
+ * left a match half indexed. A store is open in one process at a time.
+ */
+
+#ifndef HISTORIQUE_H
+#define HISTORIQUE_H
+
+#include <stdint.h>
+
+#define LEADERBOARD_SIZE 64 // number of players kept in the leaderboard
+
+/**
+ * @struct MatchRecord
+ * @brief Represents the result of a match, as stored in the log.
+ */
+typedef struct
+{
+    int64_t timestamp;   /**< End of the match, in seconds since the epoch. */
+    uint32_t playerId;   /**< Id of the player. */
+    uint32_t seed;       /**< Seed of the random generator of the match. */
+    uint32_t durationMs; /**< Duration of the match in milliseconds. */
+    uint16_t shots;      /**< Number of shots fired by the player. */
+    uint8_t won;         /**< 1 if the player won, 0 otherwise. */
+    uint8_t padding;     /**< Unused. */
+    uint64_t previous;   /**< Index + 1 of the previous match of the player, 0 if none. */
+} MatchRecord;
+
+/**
+ * @struct PlayerStats
+ * @brief Represents the statistics of a player, as stored in the index.
+ */
+typedef struct
+{
+    uint32_t playerId;   /**< Id of the player. */
+    uint32_t used;       /**< 1 if the entry of the hash table is used, 0 otherwise. */
+    uint64_t games;      /**< Number of matches played. */
+    uint64_t wins;       /**< Number of matches won. */
+    uint64_t totalShots; /**< Number of shots fired in all the matches. */
+    uint32_t bestShots;  /**< Fewest shots needed to win, 0 if never won. */
+    uint32_t padding;    /**< Unused. */
+    uint64_t lastMatch;  /**< Index + 1 of the last match of the player, 0 if none. */
+} PlayerStats;
+
+/**
+ * @struct History
+ * @brief Represents an open store (opaque).
+ */
+typedef struct History History;
+
+/**
+ * @brief Opens a store, creating its files if needed.
+ *
+ * Waits while another process has the store open.
+ * @param path The path of the store, without extension.
+ * @return A pointer to the store, NULL if the path is NULL or the files can't be
+ *         opened or are corrupted.
+ */
+History *openHistory(const char *path);
+
+/**
+ * @brief Appends a match to the store and updates the index.
+ * @param history The store.
+ * @param match The match; previous is filled by the store.
+ * @return 1 if the match was recorded, 0 otherwise (also when a parameter is NULL).
+ */
+int recordMatch(History *history, const MatchRecord *match);
+
+/**
+ * @brief Gives the number of matches in the store.
+ * @param history The store.
+ * @return The number of matches, 0 if the store is NULL.
+ */
+uint64_t countMatches(History *history);
+
+/**
+ * @brief Gives a match of the log.
+ * @param history The store.
+ * @param index The index of the match, in order of recording.
+ * @return A pointer to the match inside the mapping, NULL if the index is out of the log.
+ */
+const MatchRecord *getMatch(History *history, uint64_t index);
+
+/**
+ * @brief Gives a match in order of date, the matches of the same date in order of recording.
+ * @param history The store.
+ * @param rank The rank of the match by date.
+ * @return A pointer to the match inside the mapping, NULL if the rank is out of the log.
+ */
+const MatchRecord *getMatchByDate(History *history, uint64_t rank);
+
+/**
+ * @brief Finds the first match played at or after a date.
+ * @param history The store.
+ * @param timestamp The date, in seconds since the epoch.
+ * @return The rank of the match by date (see getMatchByDate), countMatches if there is none.
+ */
+uint64_t findMatchByDate(History *history, int64_t timestamp);
+
+/**
+ * @brief Gives the statistics of a player.
+ * @param history The store.
+ * @param playerId The id of the player.
+ * @param stats The statistics, filled by the function.
+ * @return 1 if the player has played, 0 otherwise (also when a parameter is NULL).
+ */
+int getPlayerStats(History *history, uint32_t playerId, PlayerStats *stats);
+
+/**
+ * @brief Gives the last matches of a player, the newest first.
+ * @param history The store.
+ * @param playerId The id of the player.
+ * @param matches The array filled with the matches.
+ * @param max The size of the array.
+ * @return The number of matches written in the array.
+ */
+int getPlayerHistory(History *history, uint32_t playerId, MatchRecord *matches, int max);
+
+/**
+ * @brief Gives the best players, ranked by wins then by fewest shots to win.
+ * @param history The store.
+ * @param players The array filled with the players.
+ * @param max The size of the array, at most LEADERBOARD_SIZE players are given.
+ * @return The number of players written in the array.
+ */
+int getLeaderboard(History *history, PlayerStats *players, int max);
+
+/**
+ * @brief Writes the store to the disk and closes it.
+ * @param history The store, may be NULL.
+ */
+void closeHistory(History *history);
+
+#endif // HISTORIQUE_H
@@ -1,32 +1,284 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
 #include "fonctions.h"
+#include "diffusion.h"
+#include "historique.h"
+
+#define HISTORY_PATH "historique" // path of the store of the matches
+#define STREAM_PATH "diffusion"   // path of the stream read by the spectators
+#define LEADERBOARD_SHOWN 5       // number of players shown at the end
+
+/*!
+ * \brief function to clean the buffer
+ */
+static void cleanBuffer()
+{
+    int c = 0;
+    while (c != '\n' && c != EOF)
+    {
+        c = getchar();
+    }
+}
+
+/*!
+ * \brief function to display the board
+ * \param board the board
+ * \param isPlayer 1 if it's the player's board, 0 otherwise
+ */
+static void displayBoard(Board *board, int isPlayer)
+{
+    // display the board
+    if (isPlayer == 1)
+    {
+        printf("Ton plateau:\n");
+    }
+    else
+    {
+        printf("Plateau de l'ordinateur:\n");
+    }
+    // print column number
+    printf("  ");
+    for (int i = 0; i < board->size; i++)
+    {
+        printf("%d ", i);
+    }
+    printf("\n");
+    for (int i = 0; i < board->size; i++)
+    {
+        // print row number
+        printf("%d ", i);
+        for (int j = 0; j < board->size; j++)
+        {
+            // print the case
+            CaseType type = getCase(board, i, j);
+            if (type == WATER)
+            {
+                printf("~ ");
+            }
+            else if (type == WATER_SHOT)
+            {
+                printf("o ");
+            }
+            else if (type == BOAT)
+            {
+                if (isPlayer == 1)
+                {
+                    printf("B ");
+                }
+                else
+                {
+                    printf("~ ");
+                }
+            }
+            else if (type == WRECK)
+            {
+                printf("X ");
+            }
+        }
+        printf("\n");
+    }
+}
+
+/*!
+ * \brief function to read a position typed by the player
+ * \param message the question asked to the player
+ * \return the position
+ */
+static int readPosition(const char *message)
+{
+    int position, retour = 0;
+    printf("%s", message);
+    while (retour != 1)
+    {
+        retour = scanf("%d", &position);
+        if (retour == EOF)
+        {
+            printf("\nFin de l'entrée\n");
+            exit(1);
+        }
+        cleanBuffer();
+    }
+    return position;
+}
+
+/*!
+ * \brief function to ask the player a position and fire at it
+ * \param game the game
+ */
+static void askPlayerShot(Game *game)
+{
+    Status status;
+    do
+    {
+        // ask the player to enter a position
+        int x = readPosition("Entrez la position x :");
+        int y = readPosition("Entrez la position y :");
+        printf("\n");
+        status = playerTurn(game, x, y, NULL);
+        if (status == STATUS_OUT_OF_BOARD)
+        {
+            printf("la position est en dehors du plateau de jeu\n");
+        }
+        else if (status != STATUS_OK)
+        {
+            printf("Error: %s\n", statusMessage(status));
+            exit(1);
+        }
+    } while (status != STATUS_OK);
+    // display the board
+    displayBoard(game->computerBoard, 0);
+}
+
+/*!
+ * \brief listener printing the result of each shot
+ * \param event the event
+ * \param userData unused
+ */
+static void announceShot(const ShotEvent *event, void *userData)
+{
+    (void)userData;
+    switch (event->type)
+    {
+    case SHOT_MISS:
+        printf("A l'eau\n");
+        break;
+    case SHOT_HIT:
+        printf("Touché\n");
+        break;
+    case SHOT_SUNK:
+        printf("Coulé\n");
+        break;
+    case SHOT_ALREADY_FIRED:
+        printf("Tu as déjà tiré ici\n");
+        break;
+    default:
+        break;
+    }
+}
+
+/*!
+ * \brief listener ending the game when a fleet is destroyed
+ * \param event the event
+ * \param userData pointer to the game over flag
+ */
+static void watchFleet(const ShotEvent *event, void *userData)
+{
+    if (event->type == SHOT_FLEET_DESTROYED)
+    {
+        *(int *)userData = 1;
+    }
+}
+
+/*!
+ * \brief function to give the current time in milliseconds
+ * \return the time in milliseconds
+ */
+static uint64_t nowMs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+/*!
+ * \brief function to record the match and display the leaderboard
+ * \param match the match
+ */
+static void saveMatch(MatchRecord *match)
+{
+    History *history = openHistory(HISTORY_PATH);
+    if (history == NULL)
+    {
+        printf("Impossible d'ouvrir l'historique des parties\n");
+        return;
+    }
+    if (!recordMatch(history, match))
+    {
+        printf("Impossible d'enregistrer la partie\n");
+    }
+
+    PlayerStats stats;
+    if (getPlayerStats(history, match->playerId, &stats))
+    {
+        printf("Tu as gagné %llu parties sur %llu\n", (unsigned long long)stats.wins,
+               (unsigned long long)stats.games);
+    }
+    PlayerStats leaders[LEADERBOARD_SHOWN];
+    int nbLeaders = getLeaderboard(history, leaders, LEADERBOARD_SHOWN);
+    printf("Classement:\n");
+    for (int i = 0; i < nbLeaders; i++)
+    {
+        printf("%d. joueur %u: %llu victoires, meilleure partie en %u tirs\n", i + 1, leaders[i].playerId,
+               (unsigned long long)leaders[i].wins, leaders[i].bestShots);
+    }
+    closeHistory(history);
+}
 
 int main()
 {
-    srand(time(NULL));
-    Game *game = createGame(SIZE, NB_BOAT);
+    unsigned int seed = (unsigned int)time(NULL);
+    uint64_t start = nowMs();
+    int shots = 0;
+    Game *game = NULL;
+    Status status = createGame(SIZE, NB_BOAT, seed, &game);
+    if (status != STATUS_OK)
+    {
+        printf("Error: %s\n", statusMessage(status));
+        return 1;
+    }
+    int gameOver = 0;
+    addShotListener(game->playerBoard, announceShot, NULL);
+    addShotListener(game->computerBoard, announceShot, NULL);
+    addShotListener(game->playerBoard, watchFleet, &gameOver);
+    addShotListener(game->computerBoard, watchFleet, &gameOver);
+    // stream the game to the spectators, the game goes on without them if it fails
+    Broadcast *broadcast = openBroadcast(STREAM_PATH, SIZE);
+    if (broadcast == NULL || !startBroadcast(broadcast, game->playerBoard, game->computerBoard) ||
+        !broadcastBoard(broadcast, game->playerBoard, &game->playerFleet, PLAYER_SIDE) ||
+        !broadcastBoard(broadcast, game->computerBoard, &game->computerFleet, COMPUTER_SIDE))
+    {
+        printf("Impossible de diffuser la partie aux spectateurs\n");
+    }
     displayBoard(game->playerBoard, 1);
     displayBoard(game->computerBoard, 0);
     do
     {
-        playerTurn(game);
-        if (!isGameOver(game)) // Vérifier si le jeu est terminé après chaque tour de joueur
+        askPlayerShot(game);
+        shots++;
+        if (!gameOver) // Vérifier si le jeu est terminé après chaque tour de joueur
         {
             printf("--------------------\n");
             printf("Tour de l'ordinateur\n\n");
             sleep(1);
-            computerTurn(game);
+            computerTurn(game, NULL);
+            displayBoard(game->playerBoard, 1);
             printf("--------------------\n");
             printf("A ton tour\n");
         }
-    } while (!isGameOver(game));
+    } while (!gameOver);
 
     // Afficher le message de fin de jeu
-    if (playerBoatsWrecked(game))
+    int won = !playerBoatsWrecked(game);
+    if (!won)
         printf("L'ordinateur a gagné!\n");
     else
         printf("Félicitations! Tu as gagné!\n");
 
+    // Enregistrer la partie dans l'historique
+    MatchRecord match = {0};
+    match.timestamp = (int64_t)time(NULL);
+    match.playerId = (uint32_t)getuid();
+    match.seed = seed;
+    match.durationMs = (uint32_t)(nowMs() - start);
+    match.shots = (uint16_t)shots;
+    match.won = (uint8_t)won;
+    saveMatch(&match);
+
     // Libérer la mémoire
+    closeBroadcast(broadcast);
     freeGame(game);
     return 0;
 }
@@ -0,0 +1,838 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "melee.h"
+
+#define MAX_MELEE_THREADS 256 // maximum number of threads
+#define CHUNKS_PER_THREAD 8   // pieces of work per thread, so that a slow piece doesn't hold the others
+#define FLEET_CASES 17        // cases of a fleet, each one is hit at most once
+#define SHOT_COST_NS 35       // measured time to resolve a shot or a hit on one thread
+#define WAKE_SAMPLES 16       // phases timed when the game is created to measure the cost of waking the pool
+
+/**
+ * @enum TurnPhase
+ * @brief Represents a step of the resolution of a turn run on several threads.
+ */
+typedef enum
+{
+    PHASE_COUNT,   /**< Check the shots and count them by band of rows, slice of shots by slice of shots. */
+    PHASE_SCATTER, /**< Put the shots in the order of the bands, slice of shots by slice of shots. */
+    PHASE_CASES,   /**< Apply the shots to the board, band of rows by band of rows. */
+    PHASE_FLEETS   /**< Apply the hits to the fleets, range of victims by range of victims. */
+} TurnPhase;
+
+/**
+ * @struct MeleeTurn
+ * @brief Buffers of the resolution of a turn, kept from one turn to the next.
+ */
+struct MeleeTurn
+{
+    int capacity;           /**< Number of shots the buffers hold. */
+    int *byBand;            /**< Index of each shot, sorted by band of rows, then by player. */
+    int *spare;             /**< Buffer of the sort of each band, then hits of each band by range of victims. */
+    int *hits;              /**< Hits of each range of victims by victim then by player, FLEET_CASES per victim. */
+    int *hitsSpare;         /**< Buffer of the sort of the hits. */
+    int *sliceBands;        /**< Shots of each slice in each band, then place of the first of them in byBand. */
+    Status *sliceStatus;    /**< Status of the first wrong shot of each slice, STATUS_OK if none. */
+    int *bandStart;         /**< First shot of each band in byBand. */
+    int *bandHits;          /**< First hit of each range of victims among the hits of each band in spare. */
+    int *destroyed;         /**< Players eliminated in each range of victims, from the first victim of the range. */
+    int *nbDestroyed;       /**< Number of players eliminated in each range of victims. */
+    int nbShots;            /**< Number of shots of the turn being resolved. */
+    int nbSlices;           /**< Number of slices of the shots. */
+    int nbBands;            /**< Number of bands of rows. */
+    int nbRanges;           /**< Number of ranges of victims. */
+    const MeleeShot *shots; /**< Shots of the turn being resolved. */
+    MeleeOutcome *outcomes; /**< Outcomes of the turn being resolved. */
+    TurnPhase phase;        /**< Phase being run. */
+    int nbChunks;           /**< Number of pieces of work of the phase. */
+    int nextChunk;          /**< Next piece of work to take. */
+    int64_t wakeCost;       /**< Time to wake the pool and wait for the end of a phase, in ns. */
+    int nbCores;            /**< Number of cores online when the game was created. */
+    pthread_t *workers;     /**< Threads of the pool, started with the game; the caller of a turn is one more. */
+    int nbWorkers;          /**< Number of threads of the pool. */
+    uint64_t phaseId;       /**< Number of phases given to the pool, a new one wakes the threads up. */
+    int busy;               /**< Threads of the pool still working on the phase. */
+    int stopping;           /**< 1 when the threads of the pool have to stop. */
+    pthread_mutex_t lock;   /**< Protects nextChunk, phaseId, busy and stopping. */
+    pthread_cond_t wake;    /**< Signaled when a phase is given to the pool or the pool stops. */
+    pthread_cond_t done;    /**< Signaled when the last thread of the pool ends a phase. */
+};
+
+/*!
+ * \brief function to give the first slot of the owner index to look at for a case
+ * \param game the game
+ * \param cell the case, x * size + y
+ * \return the slot
+ */
+static int hashCase(const MeleeGame *game, uint64_t cell)
+{
+    return (int)((cell * 0x9E3779B97F4A7C15ULL) >> 32) & (game->ownerCapacity - 1);
+}
+
+/*!
+ * \brief function to find the player owning the boat on a case
+ * \param game the game
+ * \param x the x position of the case
+ * \param y the y position of the case
+ * \param boatId the index of the boat in the owner's fleet, may be NULL
+ * \return the id of the owner, -1 if no boat covers the case
+ */
+int findOwner(const MeleeGame *game, int x, int y, int *boatId)
+{
+    // check if the parameters are correct
+    if (game == NULL || x < 0 || x >= game->board->size || y < 0 || y >= game->board->size)
+    {
+        return -1;
+    }
+    uint64_t cell = (uint64_t)x * game->board->size + y;
+    for (int slot = hashCase(game, cell);; slot = (slot + 1) & (game->ownerCapacity - 1))
+    {
+        if (game->ownerCases[slot] == 0)
+        {
+            return -1;
+        }
+        if (game->ownerCases[slot] == cell + 1)
+        {
+            if (boatId != NULL)
+            {
+                *boatId = game->owners[slot] % NB_BOAT;
+            }
+            return game->owners[slot] / NB_BOAT;
+        }
+    }
+}
+
+/*!
+ * \brief function to add the cases of a fleet to the owner index
+ * \param game the game
+ * \param player the id of the owner of the fleet
+ */
+static void addOwner(MeleeGame *game, int player)
+{
+    const Fleet *fleet = &game->fleets[player];
+    for (int boat = 0; boat < fleet->nbBoats; boat++)
+    {
+        for (int i = 0; i < fleet->size[boat]; i++)
+        {
+            uint64_t x = fleet->x[boat] + (fleet->orientation[boat] == HORIZONTAL ? i : 0);
+            uint64_t y = fleet->y[boat] + (fleet->orientation[boat] == VERTICAL ? i : 0);
+            uint64_t cell = x * game->board->size + y;
+            int slot = hashCase(game, cell);
+            while (game->ownerCases[slot] != 0)
+            {
+                slot = (slot + 1) & (game->ownerCapacity - 1);
+            }
+            game->ownerCases[slot] = cell + 1;
+            game->owners[slot] = player * NB_BOAT + boat;
+        }
+    }
+}
+
+/*!
+ * \brief function to give the first victim of a range of victims
+ * \param game the game
+ * \param range the range
+ * \return the id of the first victim, nbPlayers for the range after the last one
+ */
+static int firstVictim(const MeleeGame *game, int range)
+{
+    int nbRanges = game->scratch->nbRanges;
+    return (int)(((int64_t)range * game->nbPlayers + nbRanges - 1) / nbRanges);
+}
+
+/*!
+ * \brief function to give the key of a shot in a sort: by player (by victim first if asked), then by index
+ * \param turn the buffers of the turn
+ * \param shot the index of the shot
+ * \param byVictim 1 to sort by victim first, 0 otherwise
+ * \return the key, different for each shot
+ */
+static uint64_t shotKey(const struct MeleeTurn *turn, int shot, int byVictim)
+{
+    uint64_t key = (uint64_t)turn->shots[shot].player;
+    if (byVictim)
+    {
+        key += (uint64_t)turn->outcomes[shot].victim * MELEE_MAX_PLAYERS;
+    }
+    return key << 32 | (uint64_t)shot;
+}
+
+/*!
+ * \brief function to sort shots by player (by victim first if asked), then by index
+ * \param turn the buffers of the turn
+ * \param shots the indexes of the shots, sorted by the function
+ * \param buffer a buffer as large as shots
+ * \param count the number of shots
+ * \param byVictim 1 to sort by victim first, 0 otherwise
+ */
+static void sortShots(const struct MeleeTurn *turn, int *shots, int *buffer, int count, int byVictim)
+{
+    // the shots of a turn usually come in the order of the players already
+    int sorted = 1;
+    for (int i = 1; i < count && sorted; i++)
+    {
+        sorted = shotKey(turn, shots[i - 1], byVictim) < shotKey(turn, shots[i], byVictim);
+    }
+    if (sorted)
+    {
+        return;
+    }
+    // bottom-up merge sort, from one array to the other
+    int *from = shots;
+    int *to = buffer;
+    for (int width = 1; width < count; width *= 2)
+    {
+        for (int left = 0; left < count; left += 2 * width)
+        {
+            int middle = left + width < count ? left + width : count;
+            int right = left + 2 * width < count ? left + 2 * width : count;
+            int i = left, j = middle, k = left;
+            while (i < middle && j < right)
+            {
+                to[k++] = shotKey(turn, from[i], byVictim) < shotKey(turn, from[j], byVictim) ? from[i++] : from[j++];
+            }
+            while (i < middle)
+            {
+                to[k++] = from[i++];
+            }
+            while (j < right)
+            {
+                to[k++] = from[j++];
+            }
+        }
+        int *swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != shots)
+    {
+        memcpy(shots, from, count * sizeof(int));
+    }
+}
+
+/*!
+ * \brief function to check a slice of the shots and to count its shots in each band of rows
+ * \param game the game
+ * \param slice the slice
+ */
+static void countSlice(MeleeGame *game, int slice)
+{
+    struct MeleeTurn *turn = game->scratch;
+    int size = game->board->size;
+    int first = (int)((int64_t)slice * turn->nbShots / turn->nbSlices);
+    int last = (int)((int64_t)(slice + 1) * turn->nbShots / turn->nbSlices);
+    int *counts = &turn->sliceBands[slice * turn->nbBands];
+    memset(counts, 0, turn->nbBands * sizeof(int));
+    turn->sliceStatus[slice] = STATUS_OK;
+    for (int i = first; i < last; i++)
+    {
+        const MeleeShot *shot = &turn->shots[i];
+        if (!isPlayerAlive(game, shot->player))
+        {
+            turn->sliceStatus[slice] = STATUS_INVALID_ARGUMENT;
+            return;
+        }
+        if (shot->x < 0 || shot->x >= size || shot->y < 0 || shot->y >= size)
+        {
+            turn->sliceStatus[slice] = STATUS_OUT_OF_BOARD;
+            return;
+        }
+        counts[(int64_t)shot->x * turn->nbBands / size]++;
+    }
+}
+
+/*!
+ * \brief function to put the shots of a slice in the order of the bands of rows
+ * \param game the game
+ * \param slice the slice
+ */
+static void scatterSlice(MeleeGame *game, int slice)
+{
+    struct MeleeTurn *turn = game->scratch;
+    int size = game->board->size;
+    int first = (int)((int64_t)slice * turn->nbShots / turn->nbSlices);
+    int last = (int)((int64_t)(slice + 1) * turn->nbShots / turn->nbSlices);
+    int *next = &turn->sliceBands[slice * turn->nbBands];
+    // the slices are in the order of the shots, so each band keeps that order
+    for (int i = first; i < last; i++)
+    {
+        turn->byBand[next[(int64_t)turn->shots[i].x * turn->nbBands / size]++] = i;
+    }
+}
+
+/*!
+ * \brief function to apply the shots of a band of rows to the board
+ * \param game the game
+ * \param band the band
+ */
+static void resolveBand(MeleeGame *game, int band)
+{
+    struct MeleeTurn *turn = game->scratch;
+    int start = turn->bandStart[band];
+    int count = turn->bandStart[band + 1] - start;
+    // the shots are taken by player, so the lowest id takes a case shot twice
+    sortShots(turn, &turn->byBand[start], &turn->spare[start], count, 0);
+    for (int i = start; i < start + count; i++)
+    {
+        int shot = turn->byBand[i];
+        int x = turn->shots[shot].x;
+        int y = turn->shots[shot].y;
+        MeleeOutcome *outcome = &turn->outcomes[shot];
+        CaseType target = getCase(game->board, x, y);
+        outcome->victim = -1;
+        outcome->boatId = -1;
+        if (target == BOAT)
+        {
+            setCase(game->board, x, y, WRECK);
+            outcome->type = SHOT_HIT;
+            outcome->victim = findOwner(game, x, y, &outcome->boatId);
+        }
+        else if (target == WATER)
+        {
+            setCase(game->board, x, y, WATER_SHOT);
+            outcome->type = SHOT_MISS;
+        }
+        else
+        {
+            outcome->type = SHOT_ALREADY_FIRED;
+        }
+    }
+
+    // counting sort of the hits of the band by range of victims, into spare
+    int *offsets = &turn->bandHits[band * (turn->nbRanges + 1)];
+    memset(offsets, 0, (turn->nbRanges + 1) * sizeof(int));
+    for (int i = start; i < start + count; i++)
+    {
+        const MeleeOutcome *outcome = &turn->outcomes[turn->byBand[i]];
+        if (outcome->type == SHOT_HIT)
+        {
+            offsets[(int64_t)outcome->victim * turn->nbRanges / game->nbPlayers + 1]++;
+        }
+    }
+    for (int range = 0; range < turn->nbRanges; range++)
+    {
+        offsets[range + 1] += offsets[range];
+    }
+    for (int i = start; i < start + count; i++)
+    {
+        int shot = turn->byBand[i];
+        if (turn->outcomes[shot].type == SHOT_HIT)
+        {
+            int range = (int)((int64_t)turn->outcomes[shot].victim * turn->nbRanges / game->nbPlayers);
+            turn->spare[start + offsets[range]++] = shot;
+        }
+    }
+    // the loop moved each start to the end of its range
+    memmove(offsets + 1, offsets, turn->nbRanges * sizeof(int));
+    offsets[0] = 0;
+}
+
+/*!
+ * \brief function to apply the hits of a range of victims to their fleets
+ * \param game the game
+ * \param range the range
+ */
+static void resolveFleets(MeleeGame *game, int range)
+{
+    struct MeleeTurn *turn = game->scratch;
+    int first = firstVictim(game, range);
+    // the hits of the range, band by band; a case is hit once, so a fleet
+    // takes at most FLEET_CASES hits
+    int *hits = &turn->hits[FLEET_CASES * first];
+    int nbHits = 0;
+    for (int band = 0; band < turn->nbBands; band++)
+    {
+        const int *offsets = &turn->bandHits[band * (turn->nbRanges + 1)];
+        const int *bandHits = &turn->spare[turn->bandStart[band]];
+        for (int i = offsets[range]; i < offsets[range + 1]; i++)
+        {
+            hits[nbHits++] = bandHits[i];
+        }
+    }
+    // the hits are taken by victim then by player, so the lowest id is the first to hit
+    sortShots(turn, hits, &turn->hitsSpare[FLEET_CASES * first], nbHits, 1);
+    turn->nbDestroyed[range] = 0;
+    for (int i = 0; i < nbHits; i++)
+    {
+        int shot = hits[i];
+        MeleeOutcome *outcome = &turn->outcomes[shot];
+        Fleet *fleet = &game->fleets[outcome->victim];
+        int boat = outcome->boatId;
+        int offset = (turn->shots[shot].x - (int)fleet->x[boat]) + (turn->shots[shot].y - (int)fleet->y[boat]);
+        fleet->hitMask[boat] |= (uint8_t)(1u << offset);
+        if (isBoatWrecked(fleet, boat))
+        {
+            fleet->sunkMask |= (uint8_t)(1u << boat);
+            outcome->type = SHOT_SUNK;
+            if (isFleetWrecked(fleet))
+            {
+                // the hits are sorted by victim, so the ids come in order
+                outcome->type = SHOT_FLEET_DESTROYED;
+                turn->destroyed[first + turn->nbDestroyed[range]++] = outcome->victim;
+            }
+        }
+    }
+}
+
+/*!
+ * \brief function to take pieces of work of the phase until there is none left
+ * \param game the game
+ */
+static void runChunks(MeleeGame *game)
+{
+    struct MeleeTurn *turn = game->scratch;
+    for (;;)
+    {
+        pthread_mutex_lock(&turn->lock);
+        int chunk = turn->nextChunk++;
+        pthread_mutex_unlock(&turn->lock);
+        if (chunk >= turn->nbChunks)
+        {
+            break;
+        }
+        switch (turn->phase)
+        {
+        case PHASE_COUNT:
+            countSlice(game, chunk);
+            break;
+        case PHASE_SCATTER:
+            scatterSlice(game, chunk);
+            break;
+        case PHASE_CASES:
+            resolveBand(game, chunk);
+            break;
+        default:
+            resolveFleets(game, chunk);
+            break;
+        }
+    }
+}
+
+/*!
+ * \brief function run by each thread of the pool: waits for a phase, works on it, until the pool stops
+ * \param arg the game
+ * \return NULL
+ */
+static void *runPoolWorker(void *arg)
+{
+    MeleeGame *game = arg;
+    struct MeleeTurn *turn = game->scratch;
+    // started before the first phase: a phase given before this thread takes
+    // the lock is not missed
+    uint64_t seen = 0;
+    pthread_mutex_lock(&turn->lock);
+    for (;;)
+    {
+        while (turn->phaseId == seen && !turn->stopping)
+        {
+            pthread_cond_wait(&turn->wake, &turn->lock);
+        }
+        if (turn->stopping)
+        {
+            break;
+        }
+        seen = turn->phaseId;
+        pthread_mutex_unlock(&turn->lock);
+        runChunks(game);
+        pthread_mutex_lock(&turn->lock);
+        if (--turn->busy == 0)
+        {
+            pthread_cond_signal(&turn->done);
+        }
+    }
+    pthread_mutex_unlock(&turn->lock);
+    return NULL;
+}
+
+/*!
+ * \brief function to run a phase of a turn on the threads of the game
+ * \param game the game
+ * \param phase the phase
+ * \param nbChunks the number of pieces of work
+ * \param nbShots the number of shots (or hits) handled by the phase
+ */
+static void runPhase(MeleeGame *game, TurnPhase phase, int nbChunks, int nbShots)
+{
+    struct MeleeTurn *turn = game->scratch;
+    turn->phase = phase;
+    turn->nbChunks = nbChunks;
+    turn->nextChunk = 0;
+
+    // the calling thread works alone when waking the pool costs more than the
+    // time it saves; the threads beyond the cores save nothing
+    int helpers = turn->nbWorkers < turn->nbCores - 1 ? turn->nbWorkers : turn->nbCores - 1;
+    int64_t saved = (int64_t)nbShots * SHOT_COST_NS * helpers / (helpers + 1);
+    if (helpers <= 0 || saved <= turn->wakeCost)
+    {
+        runChunks(game);
+        return;
+    }
+    pthread_mutex_lock(&turn->lock);
+    turn->busy = turn->nbWorkers;
+    turn->phaseId++;
+    pthread_cond_broadcast(&turn->wake);
+    pthread_mutex_unlock(&turn->lock);
+    // the calling thread is one more worker
+    runChunks(game);
+    pthread_mutex_lock(&turn->lock);
+    while (turn->busy > 0)
+    {
+        pthread_cond_wait(&turn->done, &turn->lock);
+    }
+    pthread_mutex_unlock(&turn->lock);
+}
+
+/*!
+ * \brief function to measure the time to wake the pool and wait for the end of its phase
+ * \param game the game, with its pool started
+ */
+static void measureWake(MeleeGame *game)
+{
+    struct MeleeTurn *turn = game->scratch;
+    struct timespec start, end;
+    // with no cost every phase wakes the pool; the phases are empty
+    turn->wakeCost = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < WAKE_SAMPLES; i++)
+    {
+        runPhase(game, PHASE_COUNT, 0, 1);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    turn->wakeCost = ((int64_t)(end.tv_sec - start.tv_sec) * 1000000000 + (end.tv_nsec - start.tv_nsec)) / WAKE_SAMPLES;
+}
+
+/*!
+ * \brief function to create a free-for-all game
+ * \param size the size of the shared board
+ * \param nbPlayers the number of players
+ * \param nbThreads the number of threads resolving a turn, 0 for one per core
+ * \param seed the seed of the random generator
+ * \param game the game created
+ * \return STATUS_OK, STATUS_INVALID_ARGUMENT or STATUS_NO_MEMORY
+ */
+Status createMeleeGame(int size, int nbPlayers, int nbThreads, uint64_t seed, MeleeGame **game)
+{
+    // check if the parameters are correct
+    if (size < SIZE || size > MELEE_MAX_SIZE || nbPlayers < 2 || nbPlayers > MELEE_MAX_PLAYERS || game == NULL)
+    {
+        return STATUS_INVALID_ARGUMENT;
+    }
+    if (nbThreads < 0 || nbThreads > MAX_MELEE_THREADS)
+    {
+        return STATUS_INVALID_ARGUMENT;
+    }
+    // there must be room enough for the fleets to be placed at random
+    if ((int64_t)size * size < (int64_t)MELEE_CASES_PER_PLAYER * nbPlayers)
+    {
+        return STATUS_INVALID_ARGUMENT;
+    }
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    cores = cores < 1 ? 1 : (cores > MAX_MELEE_THREADS ? MAX_MELEE_THREADS : cores);
+    if (nbThreads == 0)
+    {
+        nbThreads = (int)cores;
+    }
+
+    MeleeGame *created = calloc(1, sizeof(MeleeGame));
+    if (created == NULL)
+    {
+        return STATUS_NO_MEMORY;
+    }
+    created->nbPlayers = nbPlayers;
+    created->playersAlive = nbPlayers;
+    created->nbThreads = nbThreads;
+    seedRandom(&created->rng, seed);
+
+    // owner index at most half full
+    created->ownerCapacity = 1;
+    while (created->ownerCapacity < 2 * FLEET_CASES * nbPlayers)
+    {
+        created->ownerCapacity *= 2;
+    }
+    created->fleets = calloc(nbPlayers, sizeof(Fleet));
+    created->eliminated = malloc(nbPlayers * sizeof(int));
+    created->ownerCases = calloc(created->ownerCapacity, sizeof(uint64_t));
+    created->owners = malloc(created->ownerCapacity * sizeof(int));
+    created->scratch = calloc(1, sizeof(struct MeleeTurn));
+    if (created->scratch != NULL)
+    {
+        created->scratch->nbCores = (int)cores;
+        pthread_mutex_init(&created->scratch->lock, NULL);
+        pthread_cond_init(&created->scratch->wake, NULL);
+        pthread_cond_init(&created->scratch->done, NULL);
+    }
+    Status status = STATUS_NO_MEMORY;
+    if (created->fleets != NULL && created->eliminated != NULL && created->ownerCases != NULL &&
+        created->owners != NULL && created->scratch != NULL)
+    {
+        // at most one band per row and one range per player
+        struct MeleeTurn *turn = created->scratch;
+        int maxBands = nbThreads * CHUNKS_PER_THREAD < size ? nbThreads * CHUNKS_PER_THREAD : size;
+        int maxRanges = nbThreads * CHUNKS_PER_THREAD < nbPlayers ? nbThreads * CHUNKS_PER_THREAD : nbPlayers;
+        turn->hits = malloc(FLEET_CASES * nbPlayers * sizeof(int));
+        turn->hitsSpare = malloc(FLEET_CASES * nbPlayers * sizeof(int));
+        turn->sliceBands = malloc(nbThreads * maxBands * sizeof(int));
+        turn->sliceStatus = malloc(nbThreads * sizeof(Status));
+        turn->bandStart = malloc((maxBands + 1) * sizeof(int));
+        turn->bandHits = malloc(maxBands * (maxRanges + 1) * sizeof(int));
+        turn->destroyed = malloc(nbPlayers * sizeof(int));
+        turn->nbDestroyed = malloc(maxRanges * sizeof(int));
+        turn->workers = malloc(nbThreads * sizeof(pthread_t));
+        if (turn->hits != NULL && turn->hitsSpare != NULL && turn->sliceBands != NULL && turn->sliceStatus != NULL &&
+            turn->bandStart != NULL && turn->bandHits != NULL && turn->destroyed != NULL &&
+            turn->nbDestroyed != NULL && turn->workers != NULL)
+        {
+            status = createBoard(size, &created->board);
+        }
+    }
+    // every player shoots everywhere: create all the tiles now, so that the
+    // threads of a turn write the board without allocating
+    for (int x = 0; x < size && status == STATUS_OK; x += TILE_SIZE)
+    {
+        for (int y = 0; y < size && status == STATUS_OK; y += TILE_SIZE)
+        {
+            status = reserveCase(created->board, x, y);
+        }
+    }
+    for (int player = 0; player < nbPlayers && status == STATUS_OK; player++)
+    {
+        status = initializeBoats(created->board, &created->fleets[player], NB_BOAT, &created->rng);
+        if (status == STATUS_OK)
+        {
+            addOwner(created, player);
+        }
+    }
+    if (status != STATUS_OK)
+    {
+        freeMeleeGame(created);
+        return status;
+    }
+    // the threads wait for the turns until the game is freed; with fewer
+    // threads than asked the turns are still resolved
+    struct MeleeTurn *turn = created->scratch;
+    while (turn->nbWorkers < nbThreads - 1 &&
+           pthread_create(&turn->workers[turn->nbWorkers], NULL, runPoolWorker, created) == 0)
+    {
+        turn->nbWorkers++;
+    }
+    if (turn->nbWorkers > 0 && cores > 1)
+    {
+        measureWake(created);
+    }
+    *game = created;
+    return STATUS_OK;
+}
+
+/*!
+ * \brief function to make the buffers of a turn hold a number of shots
+ * \param turn the buffers
+ * \param nbShots the number of shots
+ * \return STATUS_OK or STATUS_NO_MEMORY
+ */
+static Status reserveTurn(struct MeleeTurn *turn, int nbShots)
+{
+    if (nbShots <= turn->capacity)
+    {
+        return STATUS_OK;
+    }
+    int *byBand = malloc(nbShots * sizeof(int));
+    int *spare = malloc(nbShots * sizeof(int));
+    if (byBand == NULL || spare == NULL)
+    {
+        free(byBand);
+        free(spare);
+        return STATUS_NO_MEMORY;
+    }
+    free(turn->byBand);
+    free(turn->spare);
+    turn->byBand = byBand;
+    turn->spare = spare;
+    turn->capacity = nbShots;
+    return STATUS_OK;
+}
+
+/*!
+ * \brief function to resolve the shots of a turn
+ * \param game the game
+ * \param shots the shots of the turn
+ * \param nbShots the number of shots
+ * \param outcomes the result of each shot
+ * \return STATUS_OK, STATUS_INVALID_ARGUMENT, STATUS_OUT_OF_BOARD or STATUS_NO_MEMORY
+ */
+Status resolveTurn(MeleeGame *game, const MeleeShot *shots, int nbShots, MeleeOutcome *outcomes)
+{
+    // check if the parameters are correct
+    if (game == NULL || nbShots < 0 || (nbShots > 0 && (shots == NULL || outcomes == NULL)))
+    {
+        return STATUS_INVALID_ARGUMENT;
+    }
+    struct MeleeTurn *turn = game->scratch;
+    if (reserveTurn(turn, nbShots) != STATUS_OK)
+    {
+        return STATUS_NO_MEMORY;
+    }
+    int size = game->board->size;
+    int nbPlayers = game->nbPlayers;
+    int maxChunks = game->nbThreads * CHUNKS_PER_THREAD;
+    turn->shots = shots;
+    turn->outcomes = outcomes;
+    turn->nbShots = nbShots;
+    turn->nbSlices = nbShots < game->nbThreads ? (nbShots > 0 ? nbShots : 1) : game->nbThreads;
+    turn->nbBands = maxChunks < size ? maxChunks : size;
+    turn->nbRanges = maxChunks < nbPlayers ? maxChunks : nbPlayers;
+
+    // each slice of the shots is checked and counted by band of rows; the
+    // first wrong shot gives the status, and nothing has been changed yet
+    runPhase(game, PHASE_COUNT, turn->nbSlices, nbShots);
+    for (int slice = 0; slice < turn->nbSlices; slice++)
+    {
+        if (turn->sliceStatus[slice] != STATUS_OK)
+        {
+            return turn->sliceStatus[slice];
+        }
+    }
+
+    // prefix sum of the counts, band by band then slice by slice: the place
+    // of the first shot of each slice in each band
+    int next = 0;
+    for (int band = 0; band < turn->nbBands; band++)
+    {
+        turn->bandStart[band] = next;
+        for (int slice = 0; slice < turn->nbSlices; slice++)
+        {
+            int count = turn->sliceBands[slice * turn->nbBands + band];
+            turn->sliceBands[slice * turn->nbBands + band] = next;
+            next += count;
+        }
+    }
+    turn->bandStart[turn->nbBands] = next;
+    runPhase(game, PHASE_SCATTER, turn->nbSlices, nbShots);
+
+    // each case belongs to one band, and the bands split the rows, so the
+    // threads never write the same word of the board
+    runPhase(game, PHASE_CASES, turn->nbBands, nbShots);
+
+    // each fleet is updated by one thread only
+    int nbHits = 0;
+    for (int band = 0; band < turn->nbBands; band++)
+    {
+        nbHits += turn->bandHits[band * (turn->nbRanges + 1) + turn->nbRanges];
+    }
+    runPhase(game, PHASE_FLEETS, turn->nbRanges, nbHits);
+
+    // eliminations in the order of the ids: the ranges are in order
+    for (int range = 0; range < turn->nbRanges; range++)
+    {
+        const int *destroyed = &turn->destroyed[firstVictim(game, range)];
+        for (int i = 0; i < turn->nbDestroyed[range]; i++)
+        {
+            game->eliminated[nbPlayers - game->playersAlive] = destroyed[i];
+            game->playersAlive--;
+        }
+    }
+    game->turn++;
+    return STATUS_OK;
+}
+
+/*!
+ * \brief function to check if a player is still in the game
+ * \param game the game
+ * \param player the id of the player
+ * \return 1 if the player has a boat afloat, 0 otherwise
+ */
+int isPlayerAlive(const MeleeGame *game, int player)
+{
+    // check if the parameters are correct
+    if (game == NULL || player < 0 || player >= game->nbPlayers)
+    {
+        return 0;
+    }
+    return !isFleetWrecked(&game->fleets[player]);
+}
+
+/*!
+ * \brief function to check if a free-for-all game is over
+ * \param game the game
+ * \return 1 if at most one player is left, 0 otherwise
+ */
+int isMeleeOver(const MeleeGame *game)
+{
+    // check if the game is correct
+    if (game == NULL)
+    {
+        return 0;
+    }
+    // the counter is kept up to date by resolveTurn
+    return game->playersAlive <= 1;
+}
+
+/*!
+ * \brief function to give the winner of a free-for-all game
+ * \param game the game
+ * \return the id of the last player alive, -1 if the game is not over or nobody is left
+ */
+int meleeWinner(const MeleeGame *game)
+{
+    // check if the game is over with a player left
+    if (game == NULL || game->playersAlive != 1)
+    {
+        return -1;
+    }
+    for (int player = 0; player < game->nbPlayers; player++)
+    {
+        if (isPlayerAlive(game, player))
+        {
+            return player;
+        }
+    }
+    return -1;
+}
+
+/*!
+ * \brief function to free a free-for-all game
+ * \param game the game, may be NULL
+ */
+void freeMeleeGame(MeleeGame *game)
+{
+    if (game == NULL)
+    {
+        return;
+    }
+    if (game->scratch != NULL)
+    {
+        struct MeleeTurn *turn = game->scratch;
+        pthread_mutex_lock(&turn->lock);
+        turn->stopping = 1;
+        pthread_cond_broadcast(&turn->wake);
+        pthread_mutex_unlock(&turn->lock);
+        for (int t = 0; t < turn->nbWorkers; t++)
+        {
+            pthread_join(turn->workers[t], NULL);
+        }
+        free(turn->workers);
+        pthread_cond_destroy(&turn->wake);
+        pthread_cond_destroy(&turn->done);
+        free(game->scratch->byBand);
+        free(game->scratch->spare);
+        free(game->scratch->hits);
+        free(game->scratch->hitsSpare);
+        free(game->scratch->sliceBands);
+        free(game->scratch->sliceStatus);
+        free(game->scratch->bandStart);
+        free(game->scratch->bandHits);
+        free(game->scratch->destroyed);
+        free(game->scratch->nbDestroyed);
+        pthread_mutex_destroy(&game->scratch->lock);
+        free(game->scratch);
+    }
+    freeBoard(game->board);
+    free(game->fleets);
+    free(game->eliminated);
+    free(game->ownerCases);
+    free(game->owners);
+    free(game);
+}
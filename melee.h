@@ -0,0 +1,134 @@
+/**
+ * @file melee.h
+ * @brief Header file of the free-for-all mode: many fleets on one shared board.
+ *
+ * Every player has a fleet of NB_BOAT boats on the same board. At each turn the
+ * shots of all the players are collected and resolved together, on a pool of
+ * threads started with the game: the shots are checked and sorted by slices,
+ * applied to the board by bands of rows (each case belongs to one band), then
+ * to the fleets by ranges of victims. A phase too small to pay for waking the
+ * pool (timed when the game is created) is resolved by the calling thread
+ * alone. When several players shoot the same case in the same turn, the
+ * lowest player id takes it and the others get SHOT_ALREADY_FIRED, so the
+ * result of a turn doesn't depend on the order of the shots nor on the number
+ * of threads. A player is eliminated when the last boat of its fleet sinks;
+ * the shots it fired during that turn still count.
+ */
+
+#ifndef MELEE_H
+#define MELEE_H
+
+#include "fonctions.h"
+
+#define MELEE_MAX_PLAYERS 4096     // largest number of players
+#define MELEE_MAX_SIZE 4096        // largest size of a shared board
+#define MELEE_CASES_PER_PLAYER 100 // cases of the board needed for each fleet
+
+/**
+ * @struct MeleeShot
+ * @brief Represents a shot fired by a player during a turn.
+ */
+typedef struct
+{
+    int player; /**< Id of the player firing. */
+    int x;      /**< X position of the shot. */
+    int y;      /**< Y position of the shot. */
+} MeleeShot;
+
+/**
+ * @struct MeleeOutcome
+ * @brief Represents the result of a shot of a turn.
+ */
+typedef struct
+{
+    ShotEventType type; /**< SHOT_FLEET_DESTROYED when the shot eliminated the victim. */
+    int victim;         /**< Id of the player hit, -1 if none. */
+    int boatId;         /**< Index of the boat hit in the victim's fleet, -1 if none. */
+} MeleeOutcome;
+
+/**
+ * @struct MeleeGame
+ * @brief Represents a free-for-all game.
+ */
+typedef struct
+{
+    Board *board;              /**< The shared board, with the boats of every player. */
+    Fleet *fleets;             /**< Fleet of each player. */
+    int nbPlayers;             /**< Number of players. */
+    int playersAlive;          /**< Number of players not eliminated, kept up to date by resolveTurn. */
+    int *eliminated;           /**< Ids of the players eliminated, in the order of elimination. */
+    int turn;                  /**< Number of turns resolved. */
+    int nbThreads;             /**< Number of threads resolving a turn. */
+    uint64_t *ownerCases;      /**< Hash index of the boat cases: case (x * size + y) + 1, 0 if the slot is empty. */
+    int *owners;               /**< Player * NB_BOAT + boat for each slot of the index. */
+    int ownerCapacity;         /**< Number of slots of the index, a power of two. */
+    Rng rng;                   /**< Random generator used to place the fleets. */
+    struct MeleeTurn *scratch; /**< Buffers reused by each turn (private). */
+} MeleeGame;
+
+/**
+ * @brief Creates a free-for-all game and places the fleets at random.
+ * @param size The size of the shared board, from SIZE to MELEE_MAX_SIZE, with
+ *        at least MELEE_CASES_PER_PLAYER cases per player.
+ * @param nbPlayers The number of players, from 2 to MELEE_MAX_PLAYERS.
+ * @param nbThreads The number of threads resolving a turn, 0 for one per core;
+ *        all but the caller are started here and kept until freeMeleeGame.
+ * @param seed The seed of the random generator.
+ * @param game The game created.
+ * @return STATUS_OK, STATUS_INVALID_ARGUMENT or STATUS_NO_MEMORY.
+ */
+Status createMeleeGame(int size, int nbPlayers, int nbThreads, uint64_t seed, MeleeGame **game);
+
+/**
+ * @brief Finds the player owning the boat on a case.
+ * @param game The game.
+ * @param x The x position of the case.
+ * @param y The y position of the case.
+ * @param boatId The index of the boat in the owner's fleet, may be NULL.
+ * @return The id of the owner, -1 if no boat covers the case.
+ */
+int findOwner(const MeleeGame *game, int x, int y, int *boatId);
+
+/**
+ * @brief Resolves the shots of a turn.
+ *
+ * Nothing is changed when the function fails. A player may fire several shots
+ * in the same turn, and may hit its own boats.
+ * @param game The game.
+ * @param shots The shots of the turn, in any order.
+ * @param nbShots The number of shots.
+ * @param outcomes The result of each shot, in the order of the shots.
+ * @return STATUS_OK, STATUS_INVALID_ARGUMENT (also when a player is already
+ *         eliminated), STATUS_OUT_OF_BOARD or STATUS_NO_MEMORY.
+ */
+Status resolveTurn(MeleeGame *game, const MeleeShot *shots, int nbShots, MeleeOutcome *outcomes);
+
+/**
+ * @brief Checks if a player is still in the game.
+ * @param game The game.
+ * @param player The id of the player.
+ * @return 1 if the player has a boat afloat, 0 otherwise (also when the player doesn't exist).
+ */
+int isPlayerAlive(const MeleeGame *game, int player);
+
+/**
+ * @brief Checks if the game is over: at most one player is left.
+ * @param game The game.
+ * @return 1 if the game is over, 0 otherwise (also when the game is NULL).
+ */
+int isMeleeOver(const MeleeGame *game);
+
+/**
+ * @brief Gives the winner of a game.
+ * @param game The game.
+ * @return The id of the last player alive, -1 if the game is not over or nobody is left.
+ */
+int meleeWinner(const MeleeGame *game);
+
+/**
+ * @brief Frees the memory allocated for a free-for-all game.
+ * @param game The game, may be NULL.
+ */
+void freeMeleeGame(MeleeGame *game);
+
+#endif // MELEE_H
@@ -0,0 +1,143 @@
+/**
+ * @file probabilites.c
+ * @brief Prints the exact probability of each case of a board to hold a boat.
+ *
+ * The board is read on the standard input: SIZE lines of SIZE characters
+ * ('~' case not shot, 'o' water shot, 'X' wreck), then optionally one line
+ * with the sunk status of each boat of the classic fleet (5 4 3 3 2), for
+ * example "0 0 1 0 0".
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include "solveur.h"
+
+/*!
+ * \brief function to read the board on the standard input
+ * \param board the board
+ * \param fleet the fleet, its sunk status is read after the board
+ * \return 1 if the board was read, 0 otherwise
+ */
+static int readBoard(Board *board, Fleet *fleet)
+{
+    char line[256];
+    for (int x = 0; x < board->size; x++)
+    {
+        if (fgets(line, sizeof(line), stdin) == NULL)
+        {
+            return 0;
+        }
+        for (int y = 0; y < board->size; y++)
+        {
+            if (line[y] == 'o')
+            {
+                setCase(board, x, y, WATER_SHOT);
+            }
+            else if (line[y] == 'X')
+            {
+                setCase(board, x, y, WRECK);
+            }
+            else if (line[y] == '~' || line[y] == '.')
+            {
+                setCase(board, x, y, WATER);
+            }
+            else
+            {
+                return 0;
+            }
+        }
+    }
+    // the sunk status is optional
+    for (int i = 0; i < fleet->nbBoats; i++)
+    {
+        int sunk = 0;
+        if (scanf("%d", &sunk) == 1 && sunk)
+        {
+            fleet->sunkMask |= (uint8_t)(1u << i);
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    int nbThreads = 0;
+    int option;
+    while ((option = getopt(argc, argv, "t:")) != -1)
+    {
+        if (option != 't')
+        {
+            printf("Usage: %s [-t threads] < plateau\n", argv[0]);
+            return 1;
+        }
+        nbThreads = atoi(optarg);
+    }
+
+    Board *board = NULL;
+    Status status = createBoard(SIZE, &board);
+    if (status != STATUS_OK)
+    {
+        printf("Error: %s\n", statusMessage(status));
+        return 1;
+    }
+    // classic fleet, the positions are unknown
+    int boatSizes[] = {5, 4, 3, 3, 2};
+    Fleet fleet = {0};
+    for (int i = 0; i < NB_BOAT; i++)
+    {
+        fleet.size[i] = (uint8_t)boatSizes[i];
+    }
+    fleet.nbBoats = NB_BOAT;
+    if (!readBoard(board, &fleet))
+    {
+        printf("Error: the board is not correct\n");
+        freeBoard(board);
+        return 1;
+    }
+
+    Solution solution;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    status = solveBoard(board, &fleet, nbThreads, &solution);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (status != STATUS_OK)
+    {
+        printf("Error: %s\n", statusMessage(status));
+        freeBoard(board);
+        return 1;
+    }
+
+    printf("%llu placements possibles (%.3f s)\n", (unsigned long long)solution.layouts,
+           (double)(end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+    printf("Probabilité d'un bateau par case (%%):\n   ");
+    for (int y = 0; y < SIZE; y++)
+    {
+        printf("%4d", y);
+    }
+    printf("\n");
+    int best = -1;
+    for (int x = 0; x < SIZE; x++)
+    {
+        printf("%2d ", x);
+        for (int y = 0; y < SIZE; y++)
+        {
+            int cell = x * SIZE + y;
+            printf("%4.0f", 100.0 * solution.probability[cell]);
+            // the best shot is the case not shot yet most likely to hold a boat
+            if (getCase(board, x, y) == WATER && (best == -1 || solution.probability[cell] > solution.probability[best]))
+            {
+                best = cell;
+            }
+        }
+        printf("\n");
+    }
+    if (best != -1)
+    {
+        printf("Meilleur tir: x = %d, y = %d\n", best / SIZE, best % SIZE);
+    }
+    freeBoard(board);
+    return 0;
+}
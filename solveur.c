@@ -0,0 +1,1066 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include "solveur.h"
+
+#define MAX_SOLVER_THREADS 256                 // maximum number of threads
+#define COUNTER_PLANES 24                      // bits of the bit-sliced counters
+#define MAX_CHILDREN (2 * SOLVER_MAX_CASES)    // most choices at one step of the search
+#define SPLIT_DEPTH 2                          // steps of the search shared out between the threads
+#define LAST_BOATS 3                           // boats left counted from their crossings instead of being enumerated
+
+// one bit per case of the board, case x * size + y is bit x * size + y
+__extension__ typedef unsigned __int128 Bits;
+
+/**
+ * @struct Task
+ * @brief A step of the search reached after the first choices, solved by one thread.
+ */
+typedef struct
+{
+    Bits occupied;              /**< Cases covered by the boats placed. */
+    unsigned remaining;         /**< Slots left to place, one bit per slot. */
+    int first;                  /**< First placement allowed for the next slot. */
+    int nbChosen;               /**< Number of boats placed. */
+    int slot[SPLIT_DEPTH];      /**< Slot of each boat placed. */
+    int placement[SPLIT_DEPTH]; /**< Placement of each boat placed. */
+} Task;
+
+/**
+ * @struct Problem
+ * @brief Data shared by the threads, computed once from the board.
+ *
+ * The boats are sorted by decreasing size into slots. The search first covers
+ * the lowest wreck left, trying every boat left that can cover it; once every
+ * wreck is covered, the boats left are placed slot after slot on the free
+ * cases, the last three being counted from the starts each placement crosses
+ * instead of being enumerated.
+ * Among identical boats (same size and sunk status) only the first one left
+ * covers a wreck, and on free cases each one is placed after the one before it
+ * in the placement list, so each set of identical boats is counted in one
+ * order only and multiplied at the end.
+ */
+typedef struct
+{
+    int size;                                   /**< Size of the board. */
+    int nbBoats;                                /**< Number of boats. */
+    int boatSize[NB_BOAT];                      /**< Size of the boat of each slot. */
+    int afterTwin[NB_BOAT];                     /**< 1 if the boat is identical to the one of the slot before. */
+    unsigned sunkSlots;                         /**< Slots of the sunk boats, one bit per slot. */
+    int remainingCases[1 << NB_BOAT];           /**< Number of cases of each set of slots. */
+    Bits *placements[NB_BOAT];                  /**< Cases covered by each valid placement of each slot. */
+    int *placementStart[NB_BOAT];               /**< First case of each placement, plus SOLVER_MAX_CASES if vertical. */
+    int *placementIndex[NB_BOAT];               /**< Placement of each slot starting at each first case (as in placementStart). */
+    int nbPlacements[NB_BOAT];                  /**< Number of valid placements of each slot. */
+    int *covering[NB_BOAT][SOLVER_MAX_CASES];   /**< Placements of each slot covering each case. */
+    int nbCovering[NB_BOAT][SOLVER_MAX_CASES];  /**< Number of placements of each slot covering each case. */
+    Bits startsHorizontal[NB_BOAT];             /**< Cases where a horizontal boat of each slot may start. */
+    Bits startsVertical[NB_BOAT];               /**< Cases where a vertical boat of each slot may start. */
+    Bits *crossHorizontal[NB_BOAT][NB_BOAT];    /**< [a][b][p]: starts of horizontal boats of slot b crossing placement p of slot a. */
+    Bits *crossVertical[NB_BOAT][NB_BOAT];      /**< [a][b][p]: starts of vertical boats of slot b crossing placement p of slot a. */
+    Bits wreck;                                 /**< Cases shot with a boat. */
+    Bits open;                                  /**< Cases not shot yet. */
+    Task *tasks;                                /**< Work items shared out between the threads. */
+    int nbTasks;                                /**< Number of work items. */
+    int nextTask;                               /**< Next work item to take. */
+    pthread_mutex_t lock;                       /**< Protects nextTask. */
+} Problem;
+
+/**
+ * @struct Child
+ * @brief One choice at a step of the search.
+ */
+typedef struct
+{
+    int slot;      /**< Slot of the boat placed. */
+    int placement; /**< Index of the placement in the list of the slot. */
+    int first;     /**< First placement allowed for the next slot. */
+} Child;
+
+/**
+ * @struct Counter
+ * @brief Bit-sliced counters: adds a number to the counter of every case of a set in a few operations.
+ */
+typedef struct
+{
+    Bits planes[COUNTER_PLANES];        /**< Bit i of the counter of each case. */
+    uint64_t added;                     /**< Largest value a counter may have reached since the last flush. */
+    uint64_t total[SOLVER_MAX_CASES];   /**< Flushed value of each counter. */
+    uint64_t removed[SOLVER_MAX_CASES]; /**< Value to take off each counter. */
+} Counter;
+
+/**
+ * @struct SolverWorker
+ * @brief Counters of one thread.
+ */
+typedef struct
+{
+    Problem *problem;                                          /**< The problem. */
+    uint64_t layouts;                                          /**< Layouts counted by the thread. */
+    uint64_t *placementLayouts[NB_BOAT];                       /**< Layouts counted with each placement of each slot. */
+    Counter horizontal[NB_BOAT];                               /**< Starts of the horizontal boats counted with masks, by slot. */
+    Counter vertical[NB_BOAT];                                 /**< Starts of the vertical boats counted with masks, by slot. */
+    int crossed[LAST_BOATS][LAST_BOATS][2 * SOLVER_MAX_CASES]; /**< [i][j][start]: free placements of the last boat j crossing the one of the last boat i. */
+} SolverWorker;
+
+/*!
+ * \brief function to count the cases of a set
+ * \param bits the set
+ * \return the number of cases
+ */
+static int countBits(Bits bits)
+{
+    return __builtin_popcountll((uint64_t)bits) + __builtin_popcountll((uint64_t)(bits >> 64));
+}
+
+/*!
+ * \brief function to give the lowest case of a non empty set
+ * \param bits the set
+ * \return the lowest case
+ */
+static int lowestBit(Bits bits)
+{
+    uint64_t low = (uint64_t)bits;
+    return low != 0 ? __builtin_ctzll(low) : 64 + __builtin_ctzll((uint64_t)(bits >> 64));
+}
+
+/*!
+ * \brief function to give the cases above a case
+ * \param cell the case
+ * \return the cases with a greater index
+ */
+static Bits casesAbove(int cell)
+{
+    return cell + 1 >= SOLVER_MAX_CASES ? 0 : ~(Bits)0 << (cell + 1);
+}
+
+/*!
+ * \brief function to move the bit-sliced counters into the totals
+ * \param counter the counters
+ */
+static void flushCounter(Counter *counter)
+{
+    for (int plane = 0; plane < COUNTER_PLANES; plane++)
+    {
+        Bits bits = counter->planes[plane];
+        while (bits != 0)
+        {
+            counter->total[lowestBit(bits)] += (uint64_t)1 << plane;
+            bits &= bits - 1;
+        }
+        counter->planes[plane] = 0;
+    }
+    counter->added = 0;
+}
+
+/*!
+ * \brief function to add a number to the counter of every case of a set
+ * \param counter the counters
+ * \param bits the set
+ * \param value the number, below 2^COUNTER_PLANES
+ */
+static void addToCounter(Counter *counter, Bits bits, uint64_t value)
+{
+    // flush before any counter can overflow the planes
+    if (counter->added + value >= (uint64_t)1 << COUNTER_PLANES)
+    {
+        flushCounter(counter);
+    }
+    counter->added += value;
+    // binary addition with carry, plane by plane, for each bit of the value
+    for (int shift = 0; value != 0; shift++, value >>= 1)
+    {
+        Bits carry = (value & 1) ? bits : 0;
+        for (int plane = shift; carry != 0; plane++)
+        {
+            Bits next = counter->planes[plane] & carry;
+            counter->planes[plane] ^= carry;
+            carry = next;
+        }
+    }
+}
+
+/*!
+ * \brief function to take one off the counter of every case of a small set
+ * \param counter the counters
+ * \param bits the set
+ */
+static void removeFromCounter(Counter *counter, Bits bits)
+{
+    while (bits != 0)
+    {
+        counter->removed[lowestBit(bits)]++;
+        bits &= bits - 1;
+    }
+}
+
+/*!
+ * \brief function to give the starts of the boats of a slot fitting on free cases
+ * \param problem the problem
+ * \param slot the slot
+ * \param freeCases the free cases
+ * \param horizontal the starts of the horizontal boats, filled by the function
+ * \param vertical the starts of the vertical boats, filled by the function
+ */
+static void freeStarts(const Problem *problem, int slot, Bits freeCases, Bits *horizontal, Bits *vertical)
+{
+    *horizontal = freeCases & problem->startsHorizontal[slot];
+    *vertical = freeCases & problem->startsVertical[slot];
+    for (int i = 1; i < problem->boatSize[slot]; i++)
+    {
+        *horizontal &= freeCases >> (i * problem->size);
+        *vertical &= freeCases >> i;
+    }
+}
+
+/*!
+ * \brief function to count the placements of the last boat when every wreck is covered
+ * \param worker the counters of the thread
+ * \param slot the slot of the boat
+ * \param occupied the cases covered by the other boats
+ * \return the number of placements
+ */
+static uint64_t countLastBoat(SolverWorker *worker, int slot, Bits occupied)
+{
+    Bits horizontal, vertical;
+    freeStarts(worker->problem, slot, worker->problem->open & ~occupied, &horizontal, &vertical);
+    addToCounter(&worker->horizontal[slot], horizontal, 1);
+    addToCounter(&worker->vertical[slot], vertical, 1);
+    return (uint64_t)(countBits(horizontal) + countBits(vertical));
+}
+
+/*!
+ * \brief function to count the placements of the last two boats when every wreck is covered
+ * \param worker the counters of the thread
+ * \param slot the slot of the first boat
+ * \param last the slot of the last boat
+ * \param occupied the cases covered by the other boats
+ * \param first the first placement allowed for the first boat
+ * \return the number of layouts
+ */
+static uint64_t countLastTwoBoats(SolverWorker *worker, int slot, int last, Bits occupied, int first)
+{
+    const Problem *problem = worker->problem;
+    // starts of the last boat without the first one; each placement of the
+    // first boat only takes off the few starts it crosses
+    Bits horizontal, vertical;
+    freeStarts(problem, last, problem->open & ~occupied, &horizontal, &vertical);
+    int nbStarts = countBits(horizontal) + countBits(vertical);
+    int twins = problem->afterTwin[last] && last == slot + 1;
+    const Bits *placements = problem->placements[slot];
+    const Bits *crossHorizontal = problem->crossHorizontal[slot][last];
+    const Bits *crossVertical = problem->crossVertical[slot][last];
+    uint64_t total = 0;
+    uint64_t valid = 0;
+
+    for (int p = first; p < problem->nbPlacements[slot]; p++)
+    {
+        if ((placements[p] & occupied) != 0)
+        {
+            continue;
+        }
+        uint64_t count;
+        if (twins)
+        {
+            // identical boats: the last one only takes the placements after this one
+            int start = problem->placementStart[slot][p];
+            Bits after = start < SOLVER_MAX_CASES ? casesAbove(start) : 0;
+            Bits afterVertical = start < SOLVER_MAX_CASES ? ~(Bits)0 : casesAbove(start - SOLVER_MAX_CASES);
+            Bits lastHorizontal = horizontal & ~crossHorizontal[p] & after;
+            Bits lastVertical = vertical & ~crossVertical[p] & afterVertical;
+            addToCounter(&worker->horizontal[last], lastHorizontal, 1);
+            addToCounter(&worker->vertical[last], lastVertical, 1);
+            count = (uint64_t)(countBits(lastHorizontal) + countBits(lastVertical));
+        }
+        else
+        {
+            Bits crossedHorizontal = horizontal & crossHorizontal[p];
+            Bits crossedVertical = vertical & crossVertical[p];
+            removeFromCounter(&worker->horizontal[last], crossedHorizontal);
+            removeFromCounter(&worker->vertical[last], crossedVertical);
+            count = (uint64_t)(nbStarts - countBits(crossedHorizontal) - countBits(crossedVertical));
+            valid++;
+        }
+        worker->placementLayouts[slot][p] += count;
+        total += count;
+    }
+    // every start not crossed counts once per valid placement of the first boat
+    if (valid != 0)
+    {
+        addToCounter(&worker->horizontal[last], horizontal, valid);
+        addToCounter(&worker->vertical[last], vertical, valid);
+    }
+    return total;
+}
+
+/*!
+ * \brief function to list the starts of a set of placements
+ * \param horizontal the starts of the horizontal boats
+ * \param vertical the starts of the vertical boats
+ * \param starts the array filled with the starts, plus SOLVER_MAX_CASES if vertical
+ * \return the number of starts
+ */
+static int listStarts(Bits horizontal, Bits vertical, int *starts)
+{
+    int count = 0;
+    for (; horizontal != 0; horizontal &= horizontal - 1)
+    {
+        starts[count++] = lowestBit(horizontal);
+    }
+    for (; vertical != 0; vertical &= vertical - 1)
+    {
+        starts[count++] = SOLVER_MAX_CASES + lowestBit(vertical);
+    }
+    return count;
+}
+
+/*!
+ * \brief function to count the placements of the last three boats when every wreck is covered
+ * \param worker the counters of the thread
+ * \param remaining the slots of the three boats
+ * \param occupied the cases covered by the other boats
+ * \param first the first placement allowed for the first boat
+ * \return the number of layouts
+ */
+static uint64_t countLastThreeBoats(SolverWorker *worker, unsigned remaining, Bits occupied, int first)
+{
+    const Problem *problem = worker->problem;
+    int slot[LAST_BOATS];
+    Bits horizontal[LAST_BOATS], vertical[LAST_BOATS];
+    int starts[LAST_BOATS][2 * SOLVER_MAX_CASES];
+    int nbStarts[LAST_BOATS];
+    int runLength[LAST_BOATS] = {0};
+    uint64_t orders = 1;
+    int leader = 0;
+    int afterFirst = 1;
+    for (int i = 0; i < LAST_BOATS; i++)
+    {
+        slot[i] = lowestBit(remaining);
+        remaining &= remaining - 1;
+        freeStarts(problem, slot[i], problem->open & ~occupied, &horizontal[i], &vertical[i]);
+        int twin = i > 0 && slot[i] == slot[i - 1] + 1 && problem->afterTwin[slot[i]];
+        // the identical boats following the boat placed before are placed after it
+        afterFirst = afterFirst && (i == 0 || twin);
+        if (afterFirst && first == problem->nbPlacements[slot[i]])
+        {
+            horizontal[i] = 0;
+            vertical[i] = 0;
+        }
+        else if (afterFirst && first > 0)
+        {
+            int start = problem->placementStart[slot[i]][first];
+            if (start < SOLVER_MAX_CASES)
+            {
+                horizontal[i] &= ~(Bits)0 << start;
+            }
+            else
+            {
+                horizontal[i] = 0;
+                vertical[i] &= ~(Bits)0 << (start - SOLVER_MAX_CASES);
+            }
+        }
+        nbStarts[i] = listStarts(horizontal[i], vertical[i], starts[i]);
+        // identical boats are counted in every order here, a run of them is counted by its first boat
+        leader = twin ? leader : i;
+        runLength[leader]++;
+        orders *= (uint64_t)runLength[leader];
+    }
+
+    // crossed[i][j][q]: placements of boat j crossing the placement q of boat i,
+    // only needed when the third boat is the first of its run
+    int overlaps[LAST_BOATS][LAST_BOATS] = {{0}};
+    for (int i = 0; i < LAST_BOATS; i++)
+    {
+        for (int j = 0; j < LAST_BOATS; j++)
+        {
+            if (i == j || runLength[LAST_BOATS - i - j] == 0)
+            {
+                continue;
+            }
+            const Bits *crossHorizontal = problem->crossHorizontal[slot[i]][slot[j]];
+            const Bits *crossVertical = problem->crossVertical[slot[i]][slot[j]];
+            for (int n = 0; n < nbStarts[i]; n++)
+            {
+                int q = problem->placementIndex[slot[i]][starts[i][n]];
+                int count = countBits(horizontal[j] & crossHorizontal[q]) + countBits(vertical[j] & crossVertical[q]);
+                worker->crossed[i][j][starts[i][n]] = count;
+                overlaps[i][j] += count;
+            }
+        }
+    }
+
+    // layouts with placement p of boat i: the pairs of placements of the two
+    // others not crossing p, minus the pairs crossing each other
+    uint64_t total = 0;
+    for (int i = 0; i < LAST_BOATS; i++)
+    {
+        if (runLength[i] == 0)
+        {
+            continue;
+        }
+        int j = i == 0 ? 1 : 0;
+        int k = i == 2 ? 1 : 2;
+        // the other boats of the run of i, and the other runs, are counted in every order
+        uint64_t divisor = orders / (uint64_t)runLength[i];
+        for (int n = 0; n < nbStarts[i]; n++)
+        {
+            int p = problem->placementIndex[slot[i]][starts[i][n]];
+            Bits jHorizontal = horizontal[j] & problem->crossHorizontal[slot[i]][slot[j]][p];
+            Bits jVertical = vertical[j] & problem->crossVertical[slot[i]][slot[j]][p];
+            Bits kHorizontal = horizontal[k] & problem->crossHorizontal[slot[i]][slot[k]][p];
+            Bits kVertical = vertical[k] & problem->crossVertical[slot[i]][slot[k]][p];
+            int jStarts[2 * SOLVER_MAX_CASES], kStarts[2 * SOLVER_MAX_CASES];
+            int nbJ = listStarts(jHorizontal, jVertical, jStarts);
+            int nbK = listStarts(kHorizontal, kVertical, kStarts);
+            // pairs crossing each other with neither crossing p, by inclusion-exclusion
+            int64_t crossing = overlaps[j][k];
+            for (int m = 0; m < nbJ; m++)
+            {
+                int q = problem->placementIndex[slot[j]][jStarts[m]];
+                crossing -= worker->crossed[j][k][jStarts[m]];
+                crossing += countBits(kHorizontal & problem->crossHorizontal[slot[j]][slot[k]][q]) +
+                            countBits(kVertical & problem->crossVertical[slot[j]][slot[k]][q]);
+            }
+            for (int m = 0; m < nbK; m++)
+            {
+                crossing -= worker->crossed[k][j][kStarts[m]];
+            }
+            uint64_t count = (uint64_t)((int64_t)(nbStarts[j] - nbJ) * (nbStarts[k] - nbK) - crossing);
+            worker->placementLayouts[slot[i]][p] += count / divisor;
+            if (i == 0)
+            {
+                total += count;
+            }
+        }
+    }
+    return total / orders;
+}
+
+/*!
+ * \brief function to list the choices at a step of the search
+ * \param problem the problem
+ * \param occupied the cases covered by the boats placed
+ * \param remaining the slots left to place
+ * \param first the first placement allowed for the next slot on free cases
+ * \param children the array filled with the choices
+ * \return the number of choices
+ */
+static int listChildren(const Problem *problem, Bits occupied, unsigned remaining, int first, Child *children)
+{
+    int nbChildren = 0;
+    Bits uncovered = problem->wreck & ~occupied;
+    if (uncovered != 0)
+    {
+        // some boat left has to cover the lowest wreck left
+        int cell = lowestBit(uncovered);
+        for (int slot = 0; slot < problem->nbBoats; slot++)
+        {
+            int isLeft = (remaining >> slot) & 1;
+            int twinLeft = problem->afterTwin[slot] && ((remaining >> (slot - 1)) & 1);
+            if (!isLeft || twinLeft)
+            {
+                continue;
+            }
+            for (int i = 0; i < problem->nbCovering[slot][cell]; i++)
+            {
+                int p = problem->covering[slot][cell][i];
+                if ((problem->placements[slot][p] & occupied) == 0)
+                {
+                    Child child = {slot, p, 0};
+                    children[nbChildren++] = child;
+                }
+            }
+        }
+        return nbChildren;
+    }
+
+    // every wreck is covered: place the lowest slot left on free cases
+    int slot = lowestBit(remaining);
+    unsigned next = remaining & ~(1u << slot);
+    int twinNext = next != 0 && lowestBit(next) == slot + 1 && problem->afterTwin[slot + 1];
+    for (int p = first; p < problem->nbPlacements[slot]; p++)
+    {
+        if ((problem->placements[slot][p] & occupied) == 0)
+        {
+            Child child = {slot, p, twinNext ? p + 1 : 0};
+            children[nbChildren++] = child;
+        }
+    }
+    return nbChildren;
+}
+
+/*!
+ * \brief function to check if a step is solved with masks rather than with more choices
+ * \param problem the problem
+ * \param occupied the cases covered by the boats placed
+ * \param remaining the slots left to place
+ * \return 1 if the step is solved with masks, 0 otherwise
+ */
+static int isFinalStep(const Problem *problem, Bits occupied, unsigned remaining)
+{
+    return remaining == 0 || ((problem->wreck & ~occupied) == 0 && countBits(remaining) <= LAST_BOATS);
+}
+
+/*!
+ * \brief function to count the layouts of the slots left
+ * \param worker the counters of the thread
+ * \param occupied the cases covered by the boats placed
+ * \param remaining the slots left to place
+ * \param first the first placement allowed for the next slot on free cases
+ * \return the number of layouts
+ */
+static uint64_t countLayouts(SolverWorker *worker, Bits occupied, unsigned remaining, int first)
+{
+    const Problem *problem = worker->problem;
+    Bits uncovered = problem->wreck & ~occupied;
+    if (remaining == 0)
+    {
+        return uncovered == 0;
+    }
+    if (uncovered == 0)
+    {
+        // a sunk boat lies on wrecks, and they are all covered
+        if ((remaining & problem->sunkSlots) != 0)
+        {
+            return 0;
+        }
+        int slot = lowestBit(remaining);
+        unsigned next = remaining & ~(1u << slot);
+        if (next == 0)
+        {
+            return countLastBoat(worker, slot, occupied);
+        }
+        if ((next & (next - 1)) == 0)
+        {
+            return countLastTwoBoats(worker, slot, lowestBit(next), occupied, first);
+        }
+        if (countBits(remaining) == LAST_BOATS)
+        {
+            return countLastThreeBoats(worker, remaining, occupied, first);
+        }
+    }
+    else if (countBits(uncovered) > problem->remainingCases[remaining])
+    {
+        // the boats left can't cover all the wrecks left
+        return 0;
+    }
+
+    Child children[MAX_CHILDREN];
+    int nbChildren = listChildren(problem, occupied, remaining, first, children);
+    uint64_t total = 0;
+    for (int i = 0; i < nbChildren; i++)
+    {
+        const Child *child = &children[i];
+        uint64_t count = countLayouts(worker, occupied | problem->placements[child->slot][child->placement],
+                                      remaining & ~(1u << child->slot), child->first);
+        worker->placementLayouts[child->slot][child->placement] += count;
+        total += count;
+    }
+    return total;
+}
+
+/*!
+ * \brief function run by each thread: takes work items until there is none left
+ * \param arg the counters of the thread
+ * \return NULL
+ */
+static void *runSolverWorker(void *arg)
+{
+    SolverWorker *worker = arg;
+    Problem *problem = worker->problem;
+    for (;;)
+    {
+        pthread_mutex_lock(&problem->lock);
+        int index = problem->nextTask++;
+        pthread_mutex_unlock(&problem->lock);
+        if (index >= problem->nbTasks)
+        {
+            break;
+        }
+        const Task *task = &problem->tasks[index];
+        uint64_t count = countLayouts(worker, task->occupied, task->remaining, task->first);
+        for (int i = 0; i < task->nbChosen; i++)
+        {
+            worker->placementLayouts[task->slot[i]][task->placement[i]] += count;
+        }
+        worker->layouts += count;
+    }
+    for (int slot = 0; slot < NB_BOAT; slot++)
+    {
+        flushCounter(&worker->horizontal[slot]);
+        flushCounter(&worker->vertical[slot]);
+    }
+    return NULL;
+}
+
+/*!
+ * \brief function to list the work items: the steps reached after the first choices
+ * \param problem the problem
+ * \return STATUS_OK or STATUS_NO_MEMORY
+ */
+static Status buildTasks(Problem *problem)
+{
+    Task *tasks = calloc(1, sizeof(Task));
+    Child *children = malloc(MAX_CHILDREN * sizeof(Child));
+    if (tasks == NULL || children == NULL)
+    {
+        free(tasks);
+        free(children);
+        return STATUS_NO_MEMORY;
+    }
+    tasks[0].remaining = (1u << problem->nbBoats) - 1;
+    int nbTasks = 1;
+
+    for (int depth = 0; depth < SPLIT_DEPTH; depth++)
+    {
+        Task *next = malloc((size_t)nbTasks * MAX_CHILDREN * sizeof(Task));
+        if (next == NULL)
+        {
+            free(tasks);
+            free(children);
+            return STATUS_NO_MEMORY;
+        }
+        int nbNext = 0;
+        for (int t = 0; t < nbTasks; t++)
+        {
+            const Task *task = &tasks[t];
+            // the steps solved with masks are not split any more
+            if (isFinalStep(problem, task->occupied, task->remaining))
+            {
+                next[nbNext++] = *task;
+                continue;
+            }
+            int nbChildren = listChildren(problem, task->occupied, task->remaining, task->first, children);
+            for (int i = 0; i < nbChildren; i++)
+            {
+                Task child = *task;
+                child.occupied |= problem->placements[children[i].slot][children[i].placement];
+                child.remaining &= ~(1u << children[i].slot);
+                child.first = children[i].first;
+                child.slot[child.nbChosen] = children[i].slot;
+                child.placement[child.nbChosen] = children[i].placement;
+                child.nbChosen++;
+                next[nbNext++] = child;
+            }
+        }
+        free(tasks);
+        tasks = next;
+        nbTasks = nbNext;
+    }
+    free(children);
+    problem->tasks = tasks;
+    problem->nbTasks = nbTasks;
+    return STATUS_OK;
+}
+
+/*!
+ * \brief function to give the cases covered by a placement
+ * \param size the size of the board
+ * \param x the x position of the boat
+ * \param y the y position of the boat
+ * \param length the size of the boat
+ * \param orientation the orientation of the boat
+ * \return the cases covered
+ */
+static Bits placementBits(int size, int x, int y, int length, Orientation orientation)
+{
+    Bits bits = 0;
+    for (int i = 0; i < length; i++)
+    {
+        int cell = (x + (orientation == HORIZONTAL ? i : 0)) * size + y + (orientation == VERTICAL ? i : 0);
+        bits |= (Bits)1 << cell;
+    }
+    return bits;
+}
+
+/*!
+ * \brief function to free the data of a problem
+ * \param problem the problem
+ */
+static void freeProblem(Problem *problem)
+{
+    for (int slot = 0; slot < NB_BOAT; slot++)
+    {
+        free(problem->placements[slot]);
+        free(problem->placementStart[slot]);
+        free(problem->placementIndex[slot]);
+        for (int cell = 0; cell < SOLVER_MAX_CASES; cell++)
+        {
+            free(problem->covering[slot][cell]);
+        }
+        for (int other = 0; other < NB_BOAT; other++)
+        {
+            free(problem->crossHorizontal[slot][other]);
+            free(problem->crossVertical[slot][other]);
+        }
+    }
+    free(problem->tasks);
+}
+
+/*!
+ * \brief function to sort the boats into slots by decreasing size
+ * \param problem the problem
+ * \param fleet the fleet
+ */
+static void sortSlots(Problem *problem, const Fleet *fleet)
+{
+    int order[NB_BOAT];
+    for (int i = 0; i < fleet->nbBoats; i++)
+    {
+        order[i] = i;
+    }
+    // insertion sort, the sunk boats first among boats of the same size
+    for (int i = 1; i < fleet->nbBoats; i++)
+    {
+        for (int j = i; j > 0; j--)
+        {
+            int a = order[j - 1], b = order[j];
+            int sunkA = (fleet->sunkMask >> a) & 1, sunkB = (fleet->sunkMask >> b) & 1;
+            if (fleet->size[a] > fleet->size[b] || (fleet->size[a] == fleet->size[b] && sunkA >= sunkB))
+            {
+                break;
+            }
+            order[j - 1] = b;
+            order[j] = a;
+        }
+    }
+    for (int slot = 0; slot < fleet->nbBoats; slot++)
+    {
+        int boat = order[slot];
+        problem->boatSize[slot] = fleet->size[boat];
+        if ((fleet->sunkMask >> boat) & 1)
+        {
+            problem->sunkSlots |= 1u << slot;
+        }
+        problem->afterTwin[slot] = slot > 0 && problem->boatSize[slot] == problem->boatSize[slot - 1] &&
+                                   ((problem->sunkSlots >> slot) & 1) == ((problem->sunkSlots >> (slot - 1)) & 1);
+    }
+    for (unsigned set = 0; set < (1u << fleet->nbBoats); set++)
+    {
+        for (int slot = 0; slot < fleet->nbBoats; slot++)
+        {
+            if ((set >> slot) & 1)
+            {
+                problem->remainingCases[set] += problem->boatSize[slot];
+            }
+        }
+    }
+}
+
+/*!
+ * \brief function to list the valid placements of each slot, alone on the board
+ * \param problem the problem
+ * \return STATUS_OK or STATUS_NO_MEMORY
+ */
+static Status buildPlacements(Problem *problem)
+{
+    int size = problem->size;
+    for (int slot = 0; slot < problem->nbBoats; slot++)
+    {
+        int length = problem->boatSize[slot];
+        int sunk = (problem->sunkSlots >> slot) & 1;
+        problem->placements[slot] = malloc(2 * size * size * sizeof(Bits));
+        problem->placementStart[slot] = malloc(2 * size * size * sizeof(int));
+        problem->placementIndex[slot] = malloc(2 * SOLVER_MAX_CASES * sizeof(int));
+        if (problem->placements[slot] == NULL || problem->placementStart[slot] == NULL || problem->placementIndex[slot] == NULL)
+        {
+            return STATUS_NO_MEMORY;
+        }
+        // horizontal placements first, each orientation in the order of the cases
+        for (int orientation = HORIZONTAL; orientation <= VERTICAL; orientation++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                for (int y = 0; y < size; y++)
+                {
+                    int endX = x + (orientation == HORIZONTAL ? length : 1);
+                    int endY = y + (orientation == VERTICAL ? length : 1);
+                    if (endX > size || endY > size)
+                    {
+                        continue;
+                    }
+                    Bits start = (Bits)1 << (x * size + y);
+                    if (orientation == HORIZONTAL)
+                    {
+                        problem->startsHorizontal[slot] |= start;
+                    }
+                    else
+                    {
+                        problem->startsVertical[slot] |= start;
+                    }
+                    Bits placement = placementBits(size, x, y, length, orientation);
+                    int onWater = (placement & ~(problem->open | problem->wreck)) != 0;
+                    int onWrecksOnly = (placement & ~problem->wreck) == 0;
+                    if (onWater || onWrecksOnly != sunk)
+                    {
+                        continue;
+                    }
+                    int index = problem->nbPlacements[slot]++;
+                    problem->placements[slot][index] = placement;
+                    problem->placementStart[slot][index] = x * size + y + (orientation == VERTICAL ? SOLVER_MAX_CASES : 0);
+                    problem->placementIndex[slot][problem->placementStart[slot][index]] = index;
+                }
+            }
+        }
+
+        // placements covering each case, used to cover the wrecks
+        for (int p = 0; p < problem->nbPlacements[slot]; p++)
+        {
+            Bits bits = problem->placements[slot][p];
+            while (bits != 0)
+            {
+                int cell = lowestBit(bits);
+                if (problem->covering[slot][cell] == NULL)
+                {
+                    problem->covering[slot][cell] = malloc(2 * length * sizeof(int));
+                    if (problem->covering[slot][cell] == NULL)
+                    {
+                        return STATUS_NO_MEMORY;
+                    }
+                }
+                problem->covering[slot][cell][problem->nbCovering[slot][cell]++] = p;
+                bits &= bits - 1;
+            }
+        }
+    }
+    return STATUS_OK;
+}
+
+/*!
+ * \brief function to list, for each pair of slots, the starts of the second crossing each placement of the first
+ * \param problem the problem
+ * \return STATUS_OK or STATUS_NO_MEMORY
+ */
+static Status buildCrossings(Problem *problem)
+{
+    int size = problem->size;
+    for (int slot = 0; slot < problem->nbBoats; slot++)
+    {
+        for (int last = 0; last < problem->nbBoats; last++)
+        {
+            if (last == slot)
+            {
+                continue;
+            }
+            int count = problem->nbPlacements[slot] + 1;
+            Bits *horizontal = calloc(count, sizeof(Bits));
+            Bits *vertical = calloc(count, sizeof(Bits));
+            problem->crossHorizontal[slot][last] = horizontal;
+            problem->crossVertical[slot][last] = vertical;
+            if (horizontal == NULL || vertical == NULL)
+            {
+                return STATUS_NO_MEMORY;
+            }
+            for (int p = 0; p < problem->nbPlacements[slot]; p++)
+            {
+                Bits placement = problem->placements[slot][p];
+                for (int cell = 0; cell < size * size; cell++)
+                {
+                    Bits start = (Bits)1 << cell;
+                    int x = cell / size, y = cell % size;
+                    if ((problem->startsHorizontal[last] & start) &&
+                        (placementBits(size, x, y, problem->boatSize[last], HORIZONTAL) & placement))
+                    {
+                        horizontal[p] |= start;
+                    }
+                    if ((problem->startsVertical[last] & start) &&
+                        (placementBits(size, x, y, problem->boatSize[last], VERTICAL) & placement))
+                    {
+                        vertical[p] |= start;
+                    }
+                }
+            }
+        }
+    }
+    return STATUS_OK;
+}
+
+/*!
+ * \brief function to build the problem from the board and the fleet
+ * \param problem the problem, zeroed
+ * \param board the board
+ * \param fleet the fleet
+ * \return STATUS_OK or STATUS_NO_MEMORY
+ */
+static Status buildProblem(Problem *problem, const Board *board, const Fleet *fleet)
+{
+    int size = board->size;
+    problem->size = size;
+    problem->nbBoats = fleet->nbBoats;
+    for (int x = 0; x < size; x++)
+    {
+        for (int y = 0; y < size; y++)
+        {
+            Bits bit = (Bits)1 << (x * size + y);
+            CaseType type = getCase(board, x, y);
+            if (type == WRECK)
+            {
+                problem->wreck |= bit;
+            }
+            else if (type != WATER_SHOT)
+            {
+                problem->open |= bit;
+            }
+        }
+    }
+    sortSlots(problem, fleet);
+    Status status = buildPlacements(problem);
+    if (status == STATUS_OK)
+    {
+        status = buildCrossings(problem);
+    }
+    if (status == STATUS_OK)
+    {
+        status = buildTasks(problem);
+    }
+    return status;
+}
+
+/*!
+ * \brief function to add the counters of a thread to the solution
+ * \param problem the problem
+ * \param worker the counters of the thread
+ * \param solution the solution
+ */
+static void addWorker(const Problem *problem, const SolverWorker *worker, Solution *solution)
+{
+    int size = problem->size;
+    solution->layouts += worker->layouts;
+    for (int slot = 0; slot < problem->nbBoats; slot++)
+    {
+        for (int p = 0; p < problem->nbPlacements[slot]; p++)
+        {
+            uint64_t count = worker->placementLayouts[slot][p];
+            Bits bits = problem->placements[slot][p];
+            while (count != 0 && bits != 0)
+            {
+                solution->occupied[lowestBit(bits)] += count;
+                bits &= bits - 1;
+            }
+        }
+        // boats counted with masks: from their start to their last case
+        for (int cell = 0; cell < size * size; cell++)
+        {
+            uint64_t horizontal = worker->horizontal[slot].total[cell] - worker->horizontal[slot].removed[cell];
+            uint64_t vertical = worker->vertical[slot].total[cell] - worker->vertical[slot].removed[cell];
+            for (int i = 0; i < problem->boatSize[slot]; i++)
+            {
+                if (horizontal != 0)
+                {
+                    solution->occupied[cell + i * size] += horizontal;
+                }
+                if (vertical != 0)
+                {
+                    solution->occupied[cell + i] += vertical;
+                }
+            }
+        }
+    }
+}
+
+/*!
+ * \brief function to count the layouts consistent with a board
+ * \param board the board
+ * \param fleet the fleet
+ * \param nbThreads the number of threads, 0 for one per core
+ * \param solution the solution
+ * \return STATUS_OK, STATUS_INVALID_ARGUMENT or STATUS_NO_MEMORY
+ */
+Status solveBoard(const Board *board, const Fleet *fleet, int nbThreads, Solution *solution)
+{
+    // check if the parameters are correct
+    if (board == NULL || fleet == NULL || solution == NULL || nbThreads < 0 || nbThreads > MAX_SOLVER_THREADS)
+    {
+        return STATUS_INVALID_ARGUMENT;
+    }
+    if ((int64_t)board->size * board->size > SOLVER_MAX_CASES || fleet->nbBoats == 0 || fleet->nbBoats > NB_BOAT)
+    {
+        return STATUS_INVALID_ARGUMENT;
+    }
+    if (nbThreads == 0)
+    {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        nbThreads = cores < 1 ? 1 : (cores > MAX_SOLVER_THREADS ? MAX_SOLVER_THREADS : (int)cores);
+    }
+
+    Problem *problem = calloc(1, sizeof(Problem));
+    SolverWorker *workers = calloc(nbThreads, sizeof(SolverWorker));
+    pthread_t *threads = malloc(nbThreads * sizeof(pthread_t));
+    Status status = problem != NULL && workers != NULL && threads != NULL ? STATUS_OK : STATUS_NO_MEMORY;
+    if (status == STATUS_OK)
+    {
+        status = buildProblem(problem, board, fleet);
+    }
+    for (int t = 0; t < nbThreads && status == STATUS_OK; t++)
+    {
+        workers[t].problem = problem;
+        for (int slot = 0; slot < problem->nbBoats; slot++)
+        {
+            workers[t].placementLayouts[slot] = calloc(problem->nbPlacements[slot] + 1, sizeof(uint64_t));
+            if (workers[t].placementLayouts[slot] == NULL)
+            {
+                status = STATUS_NO_MEMORY;
+            }
+        }
+    }
+
+    memset(solution, 0, sizeof(Solution));
+    solution->size = board->size;
+    if (status == STATUS_OK)
+    {
+        pthread_mutex_init(&problem->lock, NULL);
+        // the calling thread is the first worker
+        int started = 1;
+        while (started < nbThreads && pthread_create(&threads[started], NULL, runSolverWorker, &workers[started]) == 0)
+        {
+            started++;
+        }
+        runSolverWorker(&workers[0]);
+        for (int t = 1; t < started; t++)
+        {
+            pthread_join(threads[t], NULL);
+        }
+        pthread_mutex_destroy(&problem->lock);
+
+        // the counters are integers, so the sum doesn't depend on the order
+        for (int t = 0; t < started; t++)
+        {
+            addWorker(problem, &workers[t], solution);
+        }
+        // each set of identical boats was counted in one order only
+        uint64_t orders = 1;
+        int run = 1;
+        for (int slot = 1; slot < problem->nbBoats; slot++)
+        {
+            run = problem->afterTwin[slot] ? run + 1 : 1;
+            orders *= (uint64_t)run;
+        }
+        solution->layouts *= orders;
+        for (int cell = 0; cell < board->size * board->size; cell++)
+        {
+            solution->occupied[cell] *= orders;
+            solution->probability[cell] = solution->layouts == 0 ? 0.0 : (double)solution->occupied[cell] / solution->layouts;
+        }
+    }
+
+    if (workers != NULL)
+    {
+        for (int t = 0; t < nbThreads; t++)
+        {
+            for (int slot = 0; slot < NB_BOAT; slot++)
+            {
+                free(workers[t].placementLayouts[slot]);
+            }
+        }
+    }
+    if (problem != NULL)
+    {
+        freeProblem(problem);
+    }
+    free(problem);
+    free(workers);
+    free(threads);
+    return status;
+}
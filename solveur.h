@@ -0,0 +1,43 @@
+/**
+ * @file solveur.h
+ * @brief Header file of the exact solver of a partially revealed board.
+ *
+ * The solver counts every layout of a fleet consistent with the shots of a
+ * board (WATER_SHOT cases hold no boat, WRECK cases are covered by a boat) and
+ * with the sunk status of each boat (a sunk boat lies on WRECK cases only, a
+ * boat afloat covers at least one case not shot yet). It gives the exact
+ * probability of each case to hold a boat. BOAT cases of the board are seen as
+ * not shot yet, and the positions stored in the fleet are not used.
+ */
+
+#ifndef SOLVEUR_H
+#define SOLVEUR_H
+
+#include "fonctions.h"
+
+#define SOLVER_MAX_CASES 128 // largest number of cases the solver handles
+
+/**
+ * @struct Solution
+ * @brief Represents the result of the solver.
+ */
+typedef struct
+{
+    int size;                             /**< Size of the board solved. */
+    uint64_t layouts;                     /**< Number of layouts consistent with the board. */
+    uint64_t occupied[SOLVER_MAX_CASES];  /**< Number of layouts with a boat on each case (x * size + y). */
+    double probability[SOLVER_MAX_CASES]; /**< Probability of each case to hold a boat. */
+} Solution;
+
+/**
+ * @brief Counts the layouts consistent with a board and gives the probability of each case.
+ * @param board The board, with the shots already fired.
+ * @param fleet The fleet: the size and the sunk status of each boat are used.
+ * @param nbThreads The number of threads, 0 for one per core.
+ * @param solution The solution filled by the function.
+ * @return STATUS_OK, STATUS_INVALID_ARGUMENT (also when the board has more than
+ *         SOLVER_MAX_CASES cases) or STATUS_NO_MEMORY.
+ */
+Status solveBoard(const Board *board, const Fleet *fleet, int nbThreads, Solution *solution);
+
+#endif // SOLVEUR_H
@@ -0,0 +1,133 @@
+/**
+ * @file spectateur.c
+ * @brief Follows a game live from the stream written by bataille_navale.
+ *
+ * Any number of spectators can watch the same game: they all read the same
+ * shared file. A spectator started during a game catches up from the last
+ * keyframe. With -1 it prints the boards once and stops.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include "diffusion.h"
+
+#define STREAM_PATH "diffusion" // path of the stream of the game
+#define POLL_MS 100             // time between two reads of the stream
+
+/*!
+ * \brief function to display a board as seen by the spectator
+ * \param spectator the spectator
+ * \param side PLAYER_SIDE or COMPUTER_SIDE
+ */
+static void displaySide(const Spectator *spectator, int side)
+{
+    int size = spectatorSize(spectator);
+    printf("  ");
+    for (int i = 0; i < size; i++)
+    {
+        printf("%d ", i);
+    }
+    printf("\n");
+    for (int i = 0; i < size; i++)
+    {
+        printf("%d ", i);
+        for (int j = 0; j < size; j++)
+        {
+            // the boats not hit yet are not in the stream
+            switch (spectatorCase(spectator, side, i, j))
+            {
+            case WATER_SHOT:
+                printf("o ");
+                break;
+            case WRECK:
+                printf("X ");
+                break;
+            default:
+                printf("~ ");
+                break;
+            }
+        }
+        printf("\n");
+    }
+}
+
+/*!
+ * \brief function to display the last shot
+ * \param delta the last shot
+ */
+static void displayShot(const StreamDelta *delta)
+{
+    const char *shooter = delta->side == COMPUTER_SIDE ? "Le joueur" : "L'ordinateur";
+    switch (delta->type)
+    {
+    case SHOT_MISS:
+        printf("%s tire en (%d, %d) : à l'eau\n", shooter, delta->x, delta->y);
+        break;
+    case SHOT_HIT:
+        printf("%s tire en (%d, %d) : touché\n", shooter, delta->x, delta->y);
+        break;
+    case SHOT_SUNK:
+        printf("%s tire en (%d, %d) : coulé\n", shooter, delta->x, delta->y);
+        break;
+    case SHOT_FLEET_DESTROYED:
+        printf("%s a coulé toute la flotte\n", shooter);
+        break;
+    default:
+        break;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int once = 0;
+    int option;
+    while ((option = getopt(argc, argv, "1")) != -1)
+    {
+        if (option != '1')
+        {
+            printf("Usage: %s [-1]\n", argv[0]);
+            return 1;
+        }
+        once = 1;
+    }
+
+    Spectator *spectator = openSpectator(STREAM_PATH);
+    if (spectator == NULL)
+    {
+        printf("Aucune partie diffusée\n");
+        return 1;
+    }
+    struct timespec pause = {0, POLL_MS * 1000000L};
+    // no shot yet: side -1
+    StreamDelta last = {-1, 0, 0, SHOT_MISS, -1};
+    // the first display shows the keyframe and the deltas written since
+    int changes = 1;
+    for (;;)
+    {
+        changes += pollSpectator(spectator, &last) > 0 ? 1 : 0;
+        if (changes > 0)
+        {
+            printf("--------------------\n");
+            printf("Plateau du joueur:\n");
+            displaySide(spectator, PLAYER_SIDE);
+            printf("Plateau de l'ordinateur:\n");
+            displaySide(spectator, COMPUTER_SIDE);
+            if (last.side != -1)
+            {
+                displayShot(&last);
+            }
+            fflush(stdout);
+            changes = 0;
+        }
+        if (once)
+        {
+            break;
+        }
+        nanosleep(&pause, NULL);
+    }
+    closeSpectator(spectator);
+    return 0;
+}
@@ -0,0 +1,257 @@
+/**
+ * @file verif_historique.c
+ * @brief Checks the store of the match results against statistics computed in memory.
+ *
+ * Records matches (with a clock going backwards), then reopens the store after
+ * closing it, after deleting its index, after corrupting the header of the
+ * index and after a crash in the middle of the indexing of a match. Each time
+ * the statistics, the leaderboard, the history of the players and the order by
+ * date must be the ones computed in memory. Returns 1 at the first difference.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "historique.h"
+
+#define STORE_PATH "verif_historique" // path of the store checked, removed at the end
+#define NB_PLAYERS 150                // more players than LEADERBOARD_SIZE
+#define NB_MATCHES 3000               // matches recorded
+#define OFFSET_INDEXED 8              // offset of indexedMatches in the header of the index
+#define OFFSET_SLOTS 16               // offset of nbSlots in the header of the index
+#define OFFSET_LEADERS 288            // offset of nbLeaders in the header of the index
+#define OFFSET_DIRTY 292              // offset of dirty in the header of the index
+
+static MatchRecord records[NB_MATCHES]; // matches recorded, in order
+static PlayerStats expected[NB_PLAYERS]; // statistics computed in memory
+
+/*!
+ * \brief function to remove the files of the store
+ */
+static void removeStore(void)
+{
+    unlink(STORE_PATH ".log");
+    unlink(STORE_PATH ".idx");
+    unlink(STORE_PATH ".dat");
+}
+
+/*!
+ * \brief function to write a value in the header of the index
+ * \param offset the offset of the field
+ * \param value the value
+ * \param bytes the size of the field
+ */
+static void corruptIndex(off_t offset, uint64_t value, size_t bytes)
+{
+    int fd = open(STORE_PATH ".idx", O_RDWR);
+    if (fd == -1 || pwrite(fd, &value, bytes, offset) != (ssize_t)bytes)
+    {
+        printf("Error: the index can't be written\n");
+        exit(1);
+    }
+    close(fd);
+}
+
+/*!
+ * \brief function to compare two players for the leaderboard, for qsort
+ * \param a the first player
+ * \param b the second player
+ * \return a negative number if a is ranked before b, a positive one otherwise
+ */
+static int compareRanks(const void *a, const void *b)
+{
+    const PlayerStats *first = a;
+    const PlayerStats *second = b;
+    uint32_t shotsFirst = first->bestShots == 0 ? UINT32_MAX : first->bestShots;
+    uint32_t shotsSecond = second->bestShots == 0 ? UINT32_MAX : second->bestShots;
+    if (first->wins != second->wins)
+    {
+        return first->wins > second->wins ? -1 : 1;
+    }
+    if (shotsFirst != shotsSecond)
+    {
+        return shotsFirst < shotsSecond ? -1 : 1;
+    }
+    return first->playerId < second->playerId ? -1 : 1;
+}
+
+/*!
+ * \brief function to check the whole store against the statistics in memory
+ * \param step the name of the step, printed on failure
+ * \return 1 if the store is correct, 0 otherwise
+ */
+static int checkStore(const char *step)
+{
+    History *history = openHistory(STORE_PATH);
+    if (history == NULL)
+    {
+        printf("%s : l'historique ne s'ouvre pas\n", step);
+        return 0;
+    }
+    int correct = countMatches(history) == NB_MATCHES;
+
+    // statistics and history of each player
+    static MatchRecord matches[NB_MATCHES];
+    for (uint32_t player = 0; player < NB_PLAYERS && correct; player++)
+    {
+        PlayerStats stats;
+        if (!getPlayerStats(history, player, &stats) || stats.games != expected[player].games ||
+            stats.wins != expected[player].wins || stats.totalShots != expected[player].totalShots ||
+            stats.bestShots != expected[player].bestShots)
+        {
+            printf("%s : statistiques fausses pour le joueur %u\n", step, player);
+            correct = 0;
+            break;
+        }
+        int count = getPlayerHistory(history, player, matches, NB_MATCHES);
+        int next = NB_MATCHES - 1;
+        for (int i = 0; i < count && correct; i++)
+        {
+            while (records[next].playerId != player)
+            {
+                next--;
+            }
+            correct = matches[i].timestamp == records[next].timestamp && matches[i].shots == records[next].shots;
+            next--;
+        }
+        if (!correct || (uint64_t)count != expected[player].games)
+        {
+            printf("%s : historique faux pour le joueur %u\n", step, player);
+            correct = 0;
+        }
+    }
+
+    // leaderboard
+    static PlayerStats ranked[NB_PLAYERS];
+    memcpy(ranked, expected, sizeof(ranked));
+    qsort(ranked, NB_PLAYERS, sizeof(PlayerStats), compareRanks);
+    PlayerStats leaders[LEADERBOARD_SIZE];
+    int nbLeaders = getLeaderboard(history, leaders, LEADERBOARD_SIZE);
+    for (int i = 0; i < nbLeaders && correct; i++)
+    {
+        correct = leaders[i].playerId == ranked[i].playerId;
+    }
+    if (correct && nbLeaders != LEADERBOARD_SIZE)
+    {
+        correct = 0;
+    }
+    if (!correct)
+    {
+        printf("%s : classement faux\n", step);
+    }
+
+    // real dates kept, in order by date, each match once
+    int64_t previous = INT64_MIN;
+    for (uint64_t rank = 0; rank < NB_MATCHES && correct; rank++)
+    {
+        const MatchRecord *match = getMatchByDate(history, rank);
+        correct = match != NULL && match->timestamp >= previous;
+        previous = correct ? match->timestamp : previous;
+    }
+    for (int i = 0; i < NB_MATCHES && correct; i += 97)
+    {
+        const MatchRecord *match = getMatch(history, (uint64_t)i);
+        correct = match != NULL && match->timestamp == records[i].timestamp;
+        uint64_t rank = findMatchByDate(history, records[i].timestamp);
+        const MatchRecord *first = getMatchByDate(history, rank);
+        correct = correct && first != NULL && first->timestamp == records[i].timestamp &&
+                  (rank == 0 || getMatchByDate(history, rank - 1)->timestamp < records[i].timestamp);
+    }
+    if (!correct)
+    {
+        printf("%s : ordre par date faux\n", step);
+    }
+    closeHistory(history);
+    return correct;
+}
+
+int main(void)
+{
+    removeStore();
+    // the clock goes back by an hour in the middle of the matches
+    int64_t clock = 1700000000;
+    for (int i = 0; i < NB_MATCHES; i++)
+    {
+        clock += i == NB_MATCHES / 2 ? -3600 : 7;
+        MatchRecord *match = &records[i];
+        match->timestamp = clock;
+        match->playerId = (uint32_t)((i * 7919) % NB_PLAYERS);
+        match->seed = (uint32_t)i;
+        match->durationMs = (uint32_t)(1000 + i);
+        match->shots = (uint16_t)(17 + (i * 31) % 80);
+        match->won = (uint8_t)((i * 13) % 3 != 0);
+
+        PlayerStats *player = &expected[match->playerId];
+        player->playerId = match->playerId;
+        player->games++;
+        player->totalShots += match->shots;
+        if (match->won)
+        {
+            player->wins++;
+            if (player->bestShots == 0 || match->shots < player->bestShots)
+            {
+                player->bestShots = match->shots;
+            }
+        }
+    }
+
+    // the parameters NULL are refused without stopping the program
+    if (openHistory(NULL) != NULL || recordMatch(NULL, &records[0]) || countMatches(NULL) != 0)
+    {
+        printf("un paramètre NULL est accepté\n");
+        return 1;
+    }
+    closeHistory(NULL);
+
+    History *history = openHistory(STORE_PATH);
+    if (history == NULL)
+    {
+        printf("Error: the store can't be created\n");
+        return 1;
+    }
+    for (int i = 0; i < NB_MATCHES; i++)
+    {
+        // a few opens in the middle: the index is brought up to date each time
+        if (i % 1000 == 999)
+        {
+            closeHistory(history);
+            history = openHistory(STORE_PATH);
+        }
+        if (history == NULL || !recordMatch(history, &records[i]))
+        {
+            printf("Error: the match %d can't be recorded\n", i);
+            return 1;
+        }
+    }
+    closeHistory(history);
+
+    int correct = checkStore("réouverture");
+    unlink(STORE_PATH ".idx");
+    correct = correct && checkStore("index supprimé");
+    unlink(STORE_PATH ".dat");
+    correct = correct && checkStore("index par date supprimé");
+    corruptIndex(OFFSET_SLOTS, 0, sizeof(uint64_t));
+    correct = correct && checkStore("nbSlots à 0");
+    corruptIndex(OFFSET_SLOTS, 3, sizeof(uint64_t));
+    correct = correct && checkStore("nbSlots à 3");
+    corruptIndex(OFFSET_LEADERS, 1000, sizeof(uint32_t));
+    correct = correct && checkStore("nbLeaders à 1000");
+    // a crash after the stats of the last match were updated, before indexedMatches
+    corruptIndex(OFFSET_INDEXED, NB_MATCHES - 1, sizeof(uint64_t));
+    corruptIndex(OFFSET_DIRTY, 1, sizeof(uint32_t));
+    correct = correct && checkStore("arrêt pendant l'indexation");
+    corruptIndex(OFFSET_INDEXED, 0, sizeof(uint64_t));
+    correct = correct && checkStore("indexedMatches à 0");
+
+    removeStore();
+    if (!correct)
+    {
+        return 1;
+    }
+    printf("verif_historique : OK\n");
+    return 0;
+}
@@ -0,0 +1,230 @@
+/**
+ * @file verif_solveur.c
+ * @brief Checks the solver against a brute-force enumeration of the layouts.
+ *
+ * Draws random partial boards (a real fleet, some random shots, the sunk status
+ * of each boat), with the classic fleet and with a fleet of mostly identical
+ * boats, enumerates every layout of the fleet one boat after the other
+ * and compares the number of layouts and the number of layouts with a boat on
+ * each case with the ones of the solver, on one thread and on several threads.
+ * Returns 1 at the first difference.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "solveur.h"
+
+#define NB_BOARDS 24 // random boards checked
+#define MAX_LENGTH 5 // size of the largest boat
+
+static const int FLEETS[2][NB_BOAT] = {{5, 4, 3, 3, 2}, {3, 3, 3, 2, 2}}; // fleets checked
+
+/**
+ * @struct Enumeration
+ * @brief Counts of the brute-force enumeration.
+ */
+typedef struct
+{
+    const Board *board;                  /**< The board. */
+    const Fleet *fleet;                  /**< The fleet. */
+    int covered[SOLVER_MAX_CASES];       /**< Number of boats placed on each case. */
+    int uncovered;                       /**< Number of wrecks not covered yet. */
+    int cells[NB_BOAT][MAX_LENGTH];      /**< Cases of the boat placed in each slot. */
+    uint64_t layouts;                    /**< Number of layouts found. */
+    uint64_t occupied[SOLVER_MAX_CASES]; /**< Number of layouts with a boat on each case. */
+} Enumeration;
+
+/*!
+ * \brief function to enumerate the placements of a boat and of the boats after it
+ * \param enumeration the counts
+ * \param boat the index of the boat to place
+ */
+static void enumerate(Enumeration *enumeration, int boat)
+{
+    const Board *board = enumeration->board;
+    int size = board->size;
+    // the boats left have to cover the wrecks left
+    int casesLeft = 0;
+    for (int i = boat; i < enumeration->fleet->nbBoats; i++)
+    {
+        casesLeft += enumeration->fleet->size[i];
+    }
+    if (enumeration->uncovered > casesLeft)
+    {
+        return;
+    }
+    if (boat == enumeration->fleet->nbBoats)
+    {
+        enumeration->layouts++;
+        for (int cell = 0; cell < size * size; cell++)
+        {
+            enumeration->occupied[cell] += enumeration->covered[cell];
+        }
+        return;
+    }
+
+    int length = enumeration->fleet->size[boat];
+    int sunk = (enumeration->fleet->sunkMask >> boat) & 1;
+    for (int orientation = HORIZONTAL; orientation <= VERTICAL; orientation++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            for (int y = 0; y < size; y++)
+            {
+                if ((orientation == HORIZONTAL ? x : y) + length > size)
+                {
+                    continue;
+                }
+                // a sunk boat lies on wrecks only, a boat afloat has a case not shot yet
+                int valid = 1;
+                int onWrecks = 0;
+                for (int i = 0; i < length && valid; i++)
+                {
+                    int cell = (x + (orientation == HORIZONTAL ? i : 0)) * size + y + (orientation == VERTICAL ? i : 0);
+                    CaseType type = getCase(board, cell / size, cell % size);
+                    valid = type != WATER_SHOT && enumeration->covered[cell] == 0;
+                    onWrecks += type == WRECK;
+                    enumeration->cells[boat][i] = cell;
+                }
+                if (!valid || (onWrecks == length) != sunk)
+                {
+                    continue;
+                }
+                for (int i = 0; i < length; i++)
+                {
+                    enumeration->covered[enumeration->cells[boat][i]] = 1;
+                }
+                enumeration->uncovered -= onWrecks;
+                enumerate(enumeration, boat + 1);
+                enumeration->uncovered += onWrecks;
+                for (int i = 0; i < length; i++)
+                {
+                    enumeration->covered[enumeration->cells[boat][i]] = 0;
+                }
+            }
+        }
+    }
+}
+
+/*!
+ * \brief function to draw a random partial board
+ * \param rng the generator
+ * \param board the board, empty, filled with the shots
+ * \param fleet the fleet, filled with the sizes and the sunk status
+ * \param boatSizes the size of each boat
+ * \param nbShots the number of shots fired
+ * \return 1 if the board was drawn, 0 otherwise
+ */
+static int drawBoard(Rng *rng, Board *board, Fleet *fleet, const int *boatSizes, int nbShots)
+{
+    int size = board->size;
+    memset(fleet, 0, sizeof(Fleet));
+    fleet->nbBoats = NB_BOAT;
+    int owner[SOLVER_MAX_CASES];
+    for (int cell = 0; cell < size * size; cell++)
+    {
+        owner[cell] = -1;
+    }
+    // the real fleet, drawn without overlap
+    for (int boat = 0; boat < NB_BOAT; boat++)
+    {
+        fleet->size[boat] = (uint8_t)boatSizes[boat];
+        for (int tries = 0;; tries++)
+        {
+            if (tries == 1000)
+            {
+                return 0;
+            }
+            int horizontal = randomBelow(rng, 2);
+            int x = randomBelow(rng, size - (horizontal ? boatSizes[boat] - 1 : 0));
+            int y = randomBelow(rng, size - (horizontal ? 0 : boatSizes[boat] - 1));
+            int free = 1;
+            for (int i = 0; i < boatSizes[boat]; i++)
+            {
+                free = free && owner[(x + (horizontal ? i : 0)) * size + y + (horizontal ? 0 : i)] == -1;
+            }
+            if (free)
+            {
+                for (int i = 0; i < boatSizes[boat]; i++)
+                {
+                    owner[(x + (horizontal ? i : 0)) * size + y + (horizontal ? 0 : i)] = boat;
+                }
+                break;
+            }
+        }
+    }
+    // random shots; a boat with every case shot is sunk
+    int hits[NB_BOAT] = {0};
+    for (int shot = 0; shot < nbShots; shot++)
+    {
+        int cell = randomBelow(rng, size * size);
+        if (getCase(board, cell / size, cell % size) != WATER)
+        {
+            continue;
+        }
+        setCase(board, cell / size, cell % size, owner[cell] == -1 ? WATER_SHOT : WRECK);
+        if (owner[cell] != -1 && ++hits[owner[cell]] == boatSizes[owner[cell]])
+        {
+            fleet->sunkMask |= (uint8_t)(1u << owner[cell]);
+        }
+    }
+    return 1;
+}
+
+int main(void)
+{
+    Rng rng;
+    seedRandom(&rng, 2024);
+    int checked = 0;
+    for (int i = 0; i < NB_BOARDS; i++)
+    {
+        // small boards nearly empty, the boards of SIZE with more shots
+        int size = i % 3 == 0 ? 6 : (i % 3 == 1 ? 8 : SIZE);
+        int nbShots = size == 6 ? 4 * (i % 4) : (size == 8 ? 20 + i : 40 + i);
+        Board *board = NULL;
+        Fleet fleet;
+        if (createBoard(size, &board) != STATUS_OK)
+        {
+            printf("Error: the board can't be created\n");
+            return 1;
+        }
+        if (!drawBoard(&rng, board, &fleet, FLEETS[(i / 3) % 2], nbShots))
+        {
+            freeBoard(board);
+            continue;
+        }
+
+        static Enumeration enumeration;
+        memset(&enumeration, 0, sizeof(enumeration));
+        enumeration.board = board;
+        enumeration.fleet = &fleet;
+        for (int cell = 0; cell < size * size; cell++)
+        {
+            enumeration.uncovered += getCase(board, cell / size, cell % size) == WRECK;
+        }
+        enumerate(&enumeration, 0);
+
+        for (int nbThreads = 1; nbThreads <= 3; nbThreads += 2)
+        {
+            Solution solution;
+            int correct = solveBoard(board, &fleet, nbThreads, &solution) == STATUS_OK &&
+                          solution.layouts == enumeration.layouts;
+            for (int cell = 0; cell < size * size && correct; cell++)
+            {
+                correct = solution.occupied[cell] == enumeration.occupied[cell];
+            }
+            if (!correct)
+            {
+                printf("plateau %d (%dx%d, %d tirs, %d threads) : %llu placements au lieu de %llu\n", i, size, size,
+                       nbShots, nbThreads, (unsigned long long)solution.layouts,
+                       (unsigned long long)enumeration.layouts);
+                freeBoard(board);
+                return 1;
+            }
+        }
+        freeBoard(board);
+        checked++;
+    }
+    printf("verif_solveur : OK (%d plateaux)\n", checked);
+    return 0;
+}